@@ -6,11 +6,20 @@ layout(location = 1) in vec2 texCoord;
 
 out vec2 v_TexCoord;
 
-uniform mat4x4 u_MVP;
+layout(std140) uniform Camera
+{
+    mat4x4 u_View;
+    mat4x4 u_Projection;
+    mat4x4 u_ViewProjection;
+    vec4 u_Viewport;
+    float u_Time;
+};
+
+uniform mat4x4 u_Model;
 
 void main()
 {
-    gl_Position = u_MVP * position;
+    gl_Position = u_ViewProjection * u_Model * position;
     v_TexCoord = texCoord;
 }
 
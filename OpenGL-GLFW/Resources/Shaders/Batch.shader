@@ -0,0 +1,76 @@
+﻿#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in float texIndex;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TexIndex;
+
+layout(std140) uniform Camera
+{
+    mat4x4 u_View;
+    mat4x4 u_Projection;
+    mat4x4 u_ViewProjection;
+    vec4 u_Viewport;
+    float u_Time;
+};
+
+void main()
+{
+    gl_Position = u_ViewProjection * position;
+    v_TexCoord = texCoord;
+    v_Color = color;
+    v_TexIndex = int(texIndex);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TexIndex;
+
+uniform sampler2D u_Textures[16];
+
+// GLSL 330 only allows constant expressions to index sampler arrays
+vec4 SampleTexture(int index, vec2 uv)
+{
+    switch (index)
+    {
+        case 0: return texture(u_Textures[0], uv);
+        case 1: return texture(u_Textures[1], uv);
+        case 2: return texture(u_Textures[2], uv);
+        case 3: return texture(u_Textures[3], uv);
+        case 4: return texture(u_Textures[4], uv);
+        case 5: return texture(u_Textures[5], uv);
+        case 6: return texture(u_Textures[6], uv);
+        case 7: return texture(u_Textures[7], uv);
+        case 8: return texture(u_Textures[8], uv);
+        case 9: return texture(u_Textures[9], uv);
+        case 10: return texture(u_Textures[10], uv);
+        case 11: return texture(u_Textures[11], uv);
+        case 12: return texture(u_Textures[12], uv);
+        case 13: return texture(u_Textures[13], uv);
+        case 14: return texture(u_Textures[14], uv);
+        case 15: return texture(u_Textures[15], uv);
+    }
+
+    return vec4(1.0);
+}
+
+void main()
+{
+    if (v_TexIndex < 0)
+    {
+        color = v_Color;
+        return;
+    }
+
+    color = SampleTexture(v_TexIndex, v_TexCoord) * v_Color;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+﻿#shader vertex
+#version 330 core
+
+out vec2 v_TexCoord;
+
+// one triangle covering the screen, built from gl_VertexID so no vertex buffer is needed
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    v_TexCoord = position;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+    vec2 offset = v_TexCoord - 0.5;
+    float vignette = 1.0 - dot(offset, offset) * 1.2;
+    color = vec4(texture(u_Texture, v_TexCoord).rgb * vignette, 1.0);
+}
\ No newline at end of file
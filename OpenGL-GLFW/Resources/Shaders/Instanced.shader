@@ -0,0 +1,42 @@
+﻿#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+// per instance, occupies locations 2 to 5
+layout(location = 2) in mat4x4 model;
+layout(location = 6) in float layer;
+
+out vec2 v_TexCoord;
+flat out float v_Layer;
+
+layout(std140) uniform Camera
+{
+    mat4x4 u_View;
+    mat4x4 u_Projection;
+    mat4x4 u_ViewProjection;
+    vec4 u_Viewport;
+    float u_Time;
+};
+
+void main()
+{
+    gl_Position = u_ViewProjection * model * position;
+    v_TexCoord = texCoord;
+    v_Layer = layer;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+flat in float v_Layer;
+
+uniform sampler2DArray u_Textures;
+
+void main()
+{
+    color = texture(u_Textures, vec3(v_TexCoord, v_Layer));
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+﻿#shader vertex
+#version 330 core
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+layout(std140) uniform Camera
+{
+    mat4x4 u_View;
+    mat4x4 u_Projection;
+    mat4x4 u_ViewProjection;
+    vec4 u_Viewport;
+    float u_Time;
+};
+// added to gl_DrawIDARB, the CPU fallback sets it per draw instead
+uniform int u_DrawIdOffset;
+// one model matrix per draw, stored as four texels
+uniform samplerBuffer u_DrawData;
+
+int GetDrawId()
+{
+#ifdef GL_ARB_shader_draw_parameters
+    return gl_DrawIDARB + u_DrawIdOffset;
+#else
+    return u_DrawIdOffset;
+#endif
+}
+
+void main()
+{
+    int base = GetDrawId() * 4;
+    mat4x4 model = mat4x4(
+        texelFetch(u_DrawData, base + 0),
+        texelFetch(u_DrawData, base + 1),
+        texelFetch(u_DrawData, base + 2),
+        texelFetch(u_DrawData, base + 3));
+
+    gl_Position = u_ViewProjection * model * position;
+    v_TexCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+    color = texture(u_Texture, v_TexCoord);
+}
\ No newline at end of file
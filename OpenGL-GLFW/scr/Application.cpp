@@ -4,6 +4,7 @@
  */
 
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -14,12 +15,29 @@
 #include <GLM/gtc/matrix_transform.hpp>
 
 #include "Renderer.h"
+#include "CameraBuffer.h"
+#include "GLStateCache.h"
+#include "BatchRenderer.h"
+#include "RenderQueue.h"
+#include "ThreadPool.h"
+#include "Frustum.h"
+#include "LooseQuadTree.h"
+#include "SceneGraph.h"
+#include "TransformSystem.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
+#include "MeshOptimizer.h"
+#include "MeshPool.h"
 #include "VertexArray.h"
+#include "VertexArrayCache.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureBuffer.h"
+#include "IndirectCommandBuffer.h"
+#include "FrameGraph.h"
 #include "Vendor/imgui.h"
 #include "Vendor/imgui_impl_glfw.h"
 #include "Vendor/imgui_impl_opengl3.h"
@@ -28,6 +46,15 @@
 
 // Takes source code of each shader and compile into shaders
 
+enum class RenderMode
+{
+    Immediate = 0,
+    Batched,
+    Queued,
+    Instanced,
+    MultiDrawIndirect,
+};
+
 int main(void)
 {
     GLFWwindow* window;
@@ -88,21 +115,92 @@ int main(void)
         };
 
         // Blending
-        GLCall(glEnable(GL_BLEND))
-        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA))
+        GLStateCache::SetBlend(true);
+        GLStateCache::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         
+        // imported meshes would go through the same pipeline, the quad just shows the report
+        MeshData quadMesh;
+        quadMesh.vertexStride = 4 * sizeof(float);
+        quadMesh.vertices.assign(reinterpret_cast<const unsigned char*>(positions), reinterpret_cast<const unsigned char*>(positions) + sizeof(positions));
+        quadMesh.indices.assign(indices, indices + 6);
+
+        const MeshOptimizationReport quadReport = MeshOptimizer::Optimize(quadMesh, 0, 2);
+
         // Setup Buffers
         // VERTEX
-        VertexArray vertexArray;
-        const VertexBuffer vertexBuffer{ positions, 4 * 4 * sizeof(float) };
+        const VertexBuffer vertexBuffer{ quadMesh.vertices.data(), static_cast<unsigned int>(quadMesh.vertices.size()) };
         
         VertexBufferLayout layout;
         layout.Push<float>(2);
         layout.Push<float>(2);
-        vertexArray.AddBuffer(vertexBuffer, layout);
 
-        // INDEX
-        const IndexBuffer indexBuffer { indices, 6 };
+        // INDEX (16 bit, the quad has far fewer than 65536 vertices)
+        const std::unique_ptr<IndexBuffer> quadIndexBuffer = MeshOptimizer::CreateIndexBuffer(quadMesh);
+        const IndexBuffer& indexBuffer = *quadIndexBuffer;
+
+        // every mesh built from the same buffers and layout gets this same vertex array back
+        VertexArrayCache vertexArrayCache;
+        const VertexArray& vertexArray = vertexArrayCache.Get(vertexBuffer, layout, &indexBuffer);
+
+        // one vertex array per vertex format, the immediate path swaps the buffer behind it per draw
+        VertexArray quadFormat;
+        quadFormat.SetFormat(layout);
+
+        // INSTANCED (same quad, one model matrix and texture array layer per instance streamed every frame)
+        struct InstanceData
+        {
+            glm::mat4x4 model;
+            float layer;
+        };
+
+        constexpr unsigned int maxInstances = 2;
+        VertexArray instancedVertexArray;
+        VertexBuffer instanceBuffer { maxInstances * sizeof(InstanceData), BufferUsage::Stream };
+
+        VertexBufferLayout instanceLayout;
+        instanceLayout.SetDivisor(1);
+        for (int column = 0; column < 4; column++)
+        {
+            instanceLayout.Push<float>(4);
+        }
+        instanceLayout.Push<float>(1);
+
+        // each instance samples its own layer, so both differently textured quads stay one draw call
+        constexpr int arraySize = 64;
+        const std::unique_ptr<Texture> instanceTextures = Texture::CreateArray(arraySize, arraySize, GL_RGBA8, maxInstances);
+        float instanceLayers[maxInstances];
+        for (unsigned int i = 0; i < maxInstances; i++)
+        {
+            const unsigned int layer = instanceTextures->AllocateLayer();
+            std::vector<unsigned char> pixels(arraySize * arraySize * 4);
+            for (int y = 0; y < arraySize; y++)
+            {
+                for (int x = 0; x < arraySize; x++)
+                {
+                    // stripes on one layer, a checker on the other
+                    const bool lit = i == 0 ? (x / 8) % 2 == 0 : (x / 8 + y / 8) % 2 == 0;
+                    unsigned char* pixel = &pixels[(y * arraySize + x) * 4];
+                    pixel[0] = lit ? 255 : 40;
+                    pixel[1] = lit ? static_cast<unsigned char>(120 + i * 120) : 40;
+                    pixel[2] = lit ? 60 : 40;
+                    pixel[3] = 255;
+                }
+            }
+
+            instanceTextures->SetLayerData(layer, pixels.data());
+            instanceLayers[i] = static_cast<float>(layer);
+        }
+
+        instancedVertexArray.AddBuffer(vertexBuffer, layout);
+        instancedVertexArray.AddBuffer(instanceBuffer, instanceLayout);
+        instancedVertexArray.SetIndexBuffer(indexBuffer);
+
+        // SHARED MESH STORAGE (both quads carved out of one page, drawn with base vertex offsets)
+        MeshPool meshPool { layout };
+        const MeshHandle meshes[] = {
+            meshPool.Allocate(positions, 4, indices, 6),
+            meshPool.Allocate(positions, 4, indices, 6),
+        };
 
         // Projection Matrix (ASPECT RATIO)
         // View Matrix (CAMERA TRANSFORM)
@@ -114,15 +212,30 @@ int main(void)
         std::string shaderPath = "./Resources/Shaders/Basic.shader";
         std::string texturePath = "./Resources/Textures/KokkuLogo.png";
         const std::string textureName = "u_Texture";
-        const std::string projectionName = "u_MVP";
+        const std::string modelName = "u_Model";
         int slot = 0;
         
         Shader shader {std::move(shaderPath)};
-        Texture texture {std::move(texturePath)};
+        Shader instancedShader {"./Resources/Shaders/Instanced.shader"};
+        Shader multiDrawShader {"./Resources/Shaders/MultiDraw.shader"};
+        // decoded in the background, the quads show the placeholder until the upload went through
+        TextureLoader textureLoader;
+        const unsigned int logoTexture = textureLoader.Load(std::move(texturePath));
+        TextureSampling textureSampling;
         shader.Bind();
-        texture.Bind(slot);
         
         shader.SetUniform1i(textureName, slot);
+
+        // unit 2, the draw data buffer of the multi draw path sits on unit 1
+        instancedShader.Bind();
+        instancedShader.SetUniform1i("u_Textures", slot + 2);
+
+        // per draw data lives on the next texture unit
+        IndirectCommandBuffer indirectCommands;
+        TextureBuffer drawData;
+        multiDrawShader.Bind();
+        multiDrawShader.SetUniform1i(textureName, slot);
+        multiDrawShader.SetUniform1i("u_DrawData", slot + 1);
         
         // unbind everything
         vertexArray.Unbind();
@@ -131,6 +244,45 @@ int main(void)
         shader.Unbind();
 
         Renderer renderer;
+        CameraBuffer camera;
+        BatchRenderer batchRenderer {"./Resources/Shaders/Batch.shader"};
+        RenderQueue renderQueue;
+        ThreadPool threadPool;
+
+        // with post processing on the scene renders into a transient target that a second pass composites to the screen
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        FrameGraph frameGraph { framebufferWidth, framebufferHeight };
+        Shader compositeShader {"./Resources/Shaders/Composite.shader"};
+        compositeShader.Bind();
+        compositeShader.SetUniform1i(textureName, slot);
+        compositeShader.Unbind();
+        VertexArray fullscreenFormat;
+        bool postProcess = false;
+
+        // a row of generated icons packed into one atlas page, the batch draws all of them with one texture slot
+        TextureAtlas atlas { 512, 1 };
+        std::vector<unsigned int> icons;
+        for (int i = 0; i < 16; i++)
+        {
+            constexpr int iconSize = 24;
+            std::vector<unsigned char> pixels(iconSize * iconSize * 4);
+            for (int y = 0; y < iconSize; y++)
+            {
+                for (int x = 0; x < iconSize; x++)
+                {
+                    const glm::vec2 offset = glm::vec2(x, y) - glm::vec2(iconSize * 0.5f - 0.5f);
+                    unsigned char* pixel = &pixels[(y * iconSize + x) * 4];
+                    pixel[0] = static_cast<unsigned char>(i * 16);
+                    pixel[1] = static_cast<unsigned char>(255 - i * 16);
+                    pixel[2] = 200;
+                    pixel[3] = glm::length(offset) < iconSize * 0.5f ? 255 : 0;
+                }
+            }
+
+            icons.push_back(atlas.Add(pixels.data(), iconSize, iconSize));
+        }
         
         // Setup ImGUI
         ImGui::CreateContext();
@@ -145,33 +297,221 @@ int main(void)
         
         glm::vec3 translationA(200, 200, 0);
         glm::vec3 translationB(400, 200, 0);
+
+        SceneGraph sceneGraph;
+        const SceneNode quadA = sceneGraph.CreateNode();
+        const SceneNode quadB = sceneGraph.CreateNode();
+
+        int renderMode = static_cast<int>(RenderMode::Immediate);
+        int spriteCount = 0;
+        SphereBounds spriteBounds;
+        LooseQuadTree spriteTree { { 0.0f, 0.0f }, { 1920.0f, 1080.0f } };
+        std::vector<unsigned int> visibleSprites;
+        std::vector<TransformBenchmark> transformBenchmarks;
+
+        // stress sprites are laid out on a grid covering twice the screen
+        const auto getSpritePosition = [](int i)
+        {
+            return glm::vec2(static_cast<float>(i % 384) * 5.0f + 2.5f, static_cast<float>(i / 384 % 216) * 5.0f + 2.5f);
+        };
         
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window))
         {
             /* Render here */
+            GLStateCache::ResetStats();
             renderer.Clear();
             
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
+
+            textureLoader.Update();
+            const Texture& texture = textureLoader.Get(logoTexture);
+            texture.Bind(slot);
+
+            // projection * view is computed and uploaded once here, draws only set their model matrix
+            camera.Update(view, projection, { 0.0f, 0.0f, 960.0f, 540.0f }, static_cast<float>(glfwGetTime()));
+
+            // world matrices are only rebuilt when a slider actually moved a quad
+            sceneGraph.SetTranslation(quadA, translationA);
+            sceneGraph.SetTranslation(quadB, translationB);
+            sceneGraph.UpdateTransforms();
             
+            // the render modes draw into whatever frame buffer is bound
+            const auto drawScene = [&]()
             {
-                glm::mat4x4 model = glm::translate(glm::mat4x4(1.0f), translationA);
-                glm::mat4x4 mvp = projection * view * model;
-                shader.Bind();
-                shader.SetUniformMatrix4f(projectionName, mvp);
-                
-                renderer.Draw(vertexArray, indexBuffer, shader);
+                if (renderMode == static_cast<int>(RenderMode::Immediate))
+                {
+                    {
+                        const glm::mat4x4& model = sceneGraph.GetWorldMatrix(quadA);
+                        shader.Bind();
+                        shader.SetUniformMatrix4f(modelName, model);
+
+                        renderer.Draw(quadFormat, vertexBuffer, indexBuffer, shader);
+                    }
+
+                    {
+                        const glm::mat4x4& model = sceneGraph.GetWorldMatrix(quadB);
+                        shader.Bind();
+                        shader.SetUniformMatrix4f(modelName, model);
+
+                        renderer.Draw(quadFormat, vertexBuffer, indexBuffer, shader);
+                    }
+                }
+                else if (renderMode == static_cast<int>(RenderMode::Queued))
+                {
+                    renderQueue.Clear();
+
+                    // sprites are spread over twice the screen and each worker culls its own slice of them
+                    if (spriteBounds.GetCount() != static_cast<unsigned int>(spriteCount))
+                    {
+                        spriteBounds.Clear();
+                        for (int i = 0; i < spriteCount; i++)
+                        {
+                            spriteBounds.Add(glm::vec3(getSpritePosition(i), 0.0f), 2.0f * 1.4142f);
+                        }
+                    }
+
+                    const Frustum frustum(camera.GetUniforms().viewProjection);
+                    const unsigned int partitionCount = threadPool.GetThreadCount();
+                    renderQueue.RecordParallel(threadPool, partitionCount, [&](unsigned int partition, CommandList& commandList)
+                    {
+                        const unsigned int begin = static_cast<unsigned int>(static_cast<long long>(spriteCount) * partition / partitionCount);
+                        const unsigned int end = static_cast<unsigned int>(static_cast<long long>(spriteCount) * (partition + 1) / partitionCount);
+
+                        std::vector<unsigned int> visible;
+                        frustum.Cull(spriteBounds, begin, end, visible);
+
+                        for (unsigned int i : visible)
+                        {
+                            const glm::vec3 position(spriteBounds.x[i], spriteBounds.y[i], spriteBounds.z[i]);
+                            glm::mat4x4 model = glm::scale(glm::translate(glm::mat4x4(1.0f), position), glm::vec3(0.04f));
+                            DrawPacket packet { &vertexArray, &indexBuffer, &shader, &texture, model };
+                            commandList.Draw(packet, RenderPass::Opaque, false, 0.0f);
+                        }
+                    });
+
+                    for (SceneNode node : { quadA, quadB })
+                    {
+                        const glm::mat4x4& model = sceneGraph.GetWorldMatrix(node);
+                        DrawPacket packet { &vertexArray, &indexBuffer, &shader, &texture, model };
+
+                        // Submit wants [0, 1] with 0 closest, the sliders move z over 0..960 and the camera looks down -z
+                        const float depth = 1.0f - sceneGraph.GetTranslation(node).z / 960.0f;
+                        renderQueue.Submit(packet, RenderPass::Translucent, true, depth);
+                    }
+
+                    renderQueue.Sort();
+                    renderQueue.Execute();
+                }
+                else if (renderMode == static_cast<int>(RenderMode::Instanced))
+                {
+                    const InstanceData instances[maxInstances] = {
+                        { sceneGraph.GetWorldMatrix(quadA), instanceLayers[0] },
+                        { sceneGraph.GetWorldMatrix(quadB), instanceLayers[1] },
+                    };
+                    instanceBuffer.Orphan();
+                    instanceBuffer.Update(0, instances, sizeof(instances));
+
+                    instanceTextures->Bind(slot + 2);
+                    instancedShader.Bind();
+                    renderer.DrawInstanced(instancedVertexArray, indexBuffer, instancedShader, maxInstances);
+                }
+                else if (renderMode == static_cast<int>(RenderMode::MultiDrawIndirect))
+                {
+                    const glm::mat4x4 models[] = {
+                        sceneGraph.GetWorldMatrix(quadA),
+                        sceneGraph.GetWorldMatrix(quadB),
+                    };
+
+                    indirectCommands.Clear();
+                    for (const MeshHandle& mesh : meshes)
+                    {
+                        indirectCommands.AddDraw(mesh.indexCount, mesh.firstIndex, mesh.baseVertex);
+                    }
+                    indirectCommands.Upload();
+
+                    drawData.SetData(models, sizeof(models));
+                    drawData.Bind(slot + 1);
+
+                    multiDrawShader.Bind();
+                    renderer.DrawMultiIndirect(meshPool.GetVertexArray(meshes[0].page), meshPool.GetIndexBuffer(meshes[0].page), multiDrawShader, indirectCommands);
+                }
+                else
+                {
+                    batchRenderer.ResetStats();
+                    batchRenderer.Begin();
+
+                    if (spriteTree.GetCount() != static_cast<unsigned int>(spriteCount))
+                    {
+                        spriteTree.Clear();
+                        for (int i = 0; i < spriteCount; i++)
+                        {
+                            const glm::vec2 position = getSpritePosition(i);
+                            spriteTree.Insert(position - 2.0f, position + 2.0f, static_cast<unsigned int>(i));
+                        }
+                    }
+
+                    // stress sprites behind the two textured quads, only the ones inside the viewport reach the batch
+                    visibleSprites.clear();
+                    spriteTree.QueryRect({ 0.0f, 0.0f }, { 960.0f, 540.0f }, visibleSprites);
+                    for (unsigned int i : visibleSprites)
+                    {
+                        const glm::vec2 position = getSpritePosition(static_cast<int>(i));
+                        batchRenderer.DrawQuad(position, { 4.0f, 4.0f }, { position.x / 960.0f, position.y / 540.0f, red, 1.0f });
+                    }
+
+                    batchRenderer.DrawQuad(glm::vec2(translationA), { 100.0f, 100.0f }, texture);
+                    batchRenderer.DrawQuad(glm::vec2(translationB), { 100.0f, 100.0f }, texture);
+
+                    for (unsigned int i = 0; i < icons.size(); i++)
+                    {
+                        if (const AtlasRegion* region = atlas.Get(icons[i]))
+                        {
+                            batchRenderer.DrawQuad({ 40.0f + i * 32.0f, 500.0f }, { 24.0f, 24.0f }, *region);
+                        }
+                    }
+
+                    batchRenderer.End();
+                    atlas.NextFrame();
+                }
+            };
+
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            if (postProcess && framebufferWidth > 0 && framebufferHeight > 0)
+            {
+                frameGraph.SetBackbufferSize(framebufferWidth, framebufferHeight);
+
+                FrameGraphResource sceneColor = 0;
+                frameGraph.AddPass("Scene", [&](FrameGraphBuilder& builder)
+                {
+                    sceneColor = builder.Create("Scene color", { framebufferWidth, framebufferHeight, GL_RGBA8 });
+                },
+                [&](const FrameGraph&)
+                {
+                    renderer.Clear();
+                    drawScene();
+                });
+
+                frameGraph.AddPass("Composite", [&](FrameGraphBuilder& builder)
+                {
+                    builder.Read(sceneColor);
+                    builder.WriteBackbuffer();
+                },
+                [&](const FrameGraph& graph)
+                {
+                    graph.GetTexture(sceneColor).Bind(slot);
+                    renderer.DrawFullscreen(fullscreenFormat, compositeShader);
+                });
+
+                frameGraph.Compile();
+                frameGraph.Execute();
+                frameGraph.Reset();
             }
-            
+            else
             {
-                glm::mat4x4 model = glm::translate(glm::mat4x4(1.0f), translationB);
-                glm::mat4x4 mvp = projection * view * model;
-                shader.Bind();
-                shader.SetUniformMatrix4f(projectionName, mvp);
-                
-                renderer.Draw(vertexArray, indexBuffer, shader);
+                drawScene();
             }
 
             if (red > 1.0f)
@@ -192,6 +532,79 @@ int main(void)
                 
                 ImGui::SliderFloat3("Translation A", &translationA.x, 0.0f, 960.0f);
                 ImGui::SliderFloat3("Translation B", &translationB.x, 0.0f, 960.0f);
+
+                ImGui::Combo("Render Mode", &renderMode, "Immediate\0Batched\0Queued\0Instanced\0Multi Draw Indirect\0");
+                ImGui::Checkbox("Post process", &postProcess);
+                if (postProcess)
+                {
+                    const FrameGraphStats& graphStats = frameGraph.GetStats();
+                    ImGui::Text("Frame graph: %u passes, %u culled, %u targets on %u textures", graphStats.passes, graphStats.culledPasses, graphStats.transientResources, graphStats.physicalTargets);
+                }
+
+                if (renderMode == static_cast<int>(RenderMode::Batched) || renderMode == static_cast<int>(RenderMode::Queued))
+                {
+                    ImGui::SliderInt("Sprites", &spriteCount, 0, 100000);
+                }
+
+                if (renderMode == static_cast<int>(RenderMode::Batched))
+                {
+                    const BatchStats& stats = batchRenderer.GetStats();
+                    ImGui::Text("Batches: %u | Quads: %u | Flushes: %u buffer, %u texture", stats.drawCalls, stats.quadCount, stats.bufferFlushes, stats.textureFlushes);
+                    ImGui::Text("Vertex streaming: %s, %u fence waits", StreamBuffer::SupportsPersistentMapping() ? "persistent mapped ring" : "unsynchronized map ring",
+                                batchRenderer.GetStreamStats().fenceWaits);
+
+                    const AtlasStats& atlasStats = atlas.GetStats();
+                    ImGui::Text("Atlas: %u images on %u pages, %u evictions, %u repacks", atlasStats.entries, atlasStats.pages, atlasStats.evictions, atlasStats.repacks);
+
+                    // window y grows downwards, the orthographic world upwards
+                    std::vector<unsigned int> picked;
+                    const ImVec2 mouse = ImGui::GetIO().MousePos;
+                    spriteTree.QueryPoint({ mouse.x, 540.0f - mouse.y }, picked);
+                    ImGui::Text("Sprites under cursor: %u", static_cast<unsigned int>(picked.size()));
+                }
+                else if (renderMode == static_cast<int>(RenderMode::MultiDrawIndirect))
+                {
+                    ImGui::Text("Path: %s", Renderer::SupportsMultiDrawIndirect() ? "glMultiDrawElementsIndirect" : "glDrawElementsBaseVertex loop");
+                }
+                else if (renderMode == static_cast<int>(RenderMode::Queued))
+                {
+                    const RenderQueueStats& stats = renderQueue.GetStats();
+                    ImGui::Text("Commands: %u | Binds: %u shader, %u texture, %u vertex array", stats.commands, stats.shaderBinds, stats.textureBinds, stats.vertexArrayBinds);
+                    ImGui::Text("Recorded on %u worker threads", threadPool.GetThreadCount());
+                }
+
+                if (ImGui::Button("Benchmark transforms"))
+                {
+                    transformBenchmarks.clear();
+                    for (unsigned int count : { 1000u, 100000u, 1000000u })
+                    {
+                        transformBenchmarks.push_back(TransformSystem::Benchmark(count));
+                    }
+                }
+
+                for (const TransformBenchmark& benchmark : transformBenchmarks)
+                {
+                    ImGui::Text("%u transforms: %.3f ms glm, %.3f ms SIMD", benchmark.count, benchmark.scalarMilliseconds, benchmark.simdMilliseconds);
+                }
+
+                ImGui::Text("Quad mesh: %u -> %u vertices, ACMR %.2f -> %.2f, ATVR %.2f -> %.2f", quadReport.vertexCountBefore, quadReport.vertexCountAfter,
+                            quadReport.before.acmr, quadReport.after.acmr, quadReport.before.atvr, quadReport.after.atvr);
+
+                const TextureLoaderStats& textureStats = textureLoader.GetStats();
+                ImGui::Text("Textures: %u loading, %u loaded, %u failed", textureStats.pending, textureStats.loaded, textureStats.failed);
+
+                // the quads minify the logo, so the mip filtering is easy to compare here
+                int textureFilter = static_cast<int>(textureSampling.filter);
+                bool samplingChanged = ImGui::Combo("Texture filter", &textureFilter, "Nearest\0Bilinear\0Trilinear\0");
+                samplingChanged |= ImGui::SliderFloat("Anisotropy", &textureSampling.anisotropy, 1.0f, Texture::GetMaxAnisotropy());
+                if (samplingChanged)
+                {
+                    textureSampling.filter = static_cast<TextureFilter>(textureFilter);
+                    textureLoader.SetSampling(textureSampling);
+                }
+
+                const GLStateStats& stateStats = GLStateCache::GetStats();
+                ImGui::Text("GL state calls: %u issued, %u skipped", stateStats.issued, stateStats.skipped);
                 ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
                 ImGui::End();
             }
@@ -207,6 +620,9 @@ int main(void)
             
             ImGui::Render();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+            // ImGui binds its own objects behind the cache's back
+            GLStateCache::Invalidate();
             
             /* Swap front and back buffers */
             glfwSwapBuffers(window);
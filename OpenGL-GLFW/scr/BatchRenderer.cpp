@@ -0,0 +1,150 @@
+﻿#include "BatchRenderer.h"
+
+#include "Renderer.h"
+
+BatchRenderer::BatchRenderer(std::string&& shaderPath, unsigned int maxQuads, unsigned int batchesPerFrame)
+    : maxQuads(maxQuads), textureSlots(), textureSlotCount(0),
+      vertexBuffer(GL_ARRAY_BUFFER, batchesPerFrame * maxQuads * 4 * sizeof(QuadVertex)),
+      indexBuffer(BuildQuadIndices(maxQuads).data(), maxQuads * 6),
+      shader(std::move(shaderPath))
+{
+    vertices.reserve(maxQuads * 4);
+
+    vertexArray.AddBuffer(vertexBuffer, QuadVertexLayout());
+
+    int samplers[MaxTextureSlots];
+    for (unsigned int i = 0; i < MaxTextureSlots; i++)
+    {
+        samplers[i] = static_cast<int>(i);
+    }
+
+    shader.Bind();
+    shader.SetUniform1iv("u_Textures", MaxTextureSlots, samplers);
+
+    vertexArray.Unbind();
+    shader.Unbind();
+}
+
+void BatchRenderer::Begin()
+{
+    vertices.clear();
+    textureSlotCount = 0;
+}
+
+void BatchRenderer::End()
+{
+    Flush();
+    vertexBuffer.EndFrame();
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    ReserveQuad();
+
+    // negative index tells the shader to skip texture sampling
+    PushQuad(position, size, color, -1.0f);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+{
+    ReserveQuad();
+
+    const float texIndex = GetTextureSlot(texture);
+    PushQuad(position, size, tint, texIndex);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tint)
+{
+    ReserveQuad();
+
+    const float texIndex = GetTextureSlot(*region.texture);
+    PushQuad(position, size, tint, texIndex, region.uvMin, region.uvMax);
+}
+
+void BatchRenderer::Flush()
+{
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < textureSlotCount; i++)
+    {
+        textureSlots[i]->Bind(i);
+    }
+
+    const unsigned int quadCount = static_cast<unsigned int>(vertices.size() / 4);
+    const unsigned int offset = vertexBuffer.Write(vertices.data(), static_cast<unsigned int>(vertices.size() * sizeof(QuadVertex)), sizeof(QuadVertex));
+
+    shader.Bind();
+    vertexArray.Bind();
+    indexBuffer.Bind();
+    // the shared quad indices start at 0, the base vertex moves them onto this batch inside the ring
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, quadCount * 6, indexBuffer.GetIndexType(), nullptr, static_cast<int>(offset / sizeof(QuadVertex))))
+
+    stats.drawCalls++;
+    stats.quadCount += quadCount;
+
+    vertices.clear();
+    textureSlotCount = 0;
+}
+
+void BatchRenderer::ReserveQuad()
+{
+    if (vertices.size() >= maxQuads * 4)
+    {
+        stats.bufferFlushes++;
+        Flush();
+    }
+}
+
+void BatchRenderer::PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex, const glm::vec2& uvMin, const glm::vec2& uvMax)
+{
+    const glm::vec2 half = size * 0.5f;
+
+    vertices.push_back({ { position.x - half.x, position.y - half.y }, { uvMin.x, uvMin.y }, color, texIndex });
+    vertices.push_back({ { position.x + half.x, position.y - half.y }, { uvMax.x, uvMin.y }, color, texIndex });
+    vertices.push_back({ { position.x + half.x, position.y + half.y }, { uvMax.x, uvMax.y }, color, texIndex });
+    vertices.push_back({ { position.x - half.x, position.y + half.y }, { uvMin.x, uvMax.y }, color, texIndex });
+}
+
+float BatchRenderer::GetTextureSlot(const Texture& texture)
+{
+    for (unsigned int i = 0; i < textureSlotCount; i++)
+    {
+        if (textureSlots[i]->GetRendererId() == texture.GetRendererId())
+        {
+            return static_cast<float>(i);
+        }
+    }
+
+    if (textureSlotCount >= MaxTextureSlots)
+    {
+        stats.textureFlushes++;
+        Flush();
+    }
+
+    textureSlots[textureSlotCount] = &texture;
+    return static_cast<float>(textureSlotCount++);
+}
+
+std::vector<unsigned int> BatchRenderer::BuildQuadIndices(unsigned int maxQuads)
+{
+    std::vector<unsigned int> indices(maxQuads * 6);
+
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < indices.size(); i += 6)
+    {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+
+        offset += 4;
+    }
+
+    return indices;
+}
@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+
+struct QuadVertex
+{
+    glm::vec2 position;
+    glm::vec2 texCoord;
+    glm::vec4 color;
+    float texIndex;
+};
+
+using QuadVertexLayout = Layout<Attr<float, 2>, Attr<float, 2>, Attr<float, 4>, Attr<float, 1>>;
+static_assert(QuadVertexLayout::Matches<QuadVertex>(), "QuadVertexLayout does not match QuadVertex");
+static_assert(QuadVertexLayout::Offset<1>() == offsetof(QuadVertex, texCoord), "QuadVertex::texCoord offset mismatch");
+static_assert(QuadVertexLayout::Offset<2>() == offsetof(QuadVertex, color), "QuadVertex::color offset mismatch");
+static_assert(QuadVertexLayout::Offset<3>() == offsetof(QuadVertex, texIndex), "QuadVertex::texIndex offset mismatch");
+
+struct BatchStats
+{
+    unsigned int drawCalls = 0;
+    unsigned int quadCount = 0;
+    // flushes forced before End() because the vertex buffer or the texture slots ran out
+    unsigned int bufferFlushes = 0;
+    unsigned int textureFlushes = 0;
+};
+
+class BatchRenderer
+{
+public:
+    // maxQuads is the size of one batch. Each ring region of the vertex stream holds batchesPerFrame of
+    // them, so a frame only moves to the next region at End(). Larger frames still work, but their
+    // extra regions may wait on fences of this very frame (see GetStreamStats().fenceWaits).
+    BatchRenderer(std::string&& shaderPath, unsigned int maxQuads = 10000, unsigned int batchesPerFrame = 4);
+    ~BatchRenderer() = default;
+
+    void Begin();
+    void End();
+
+    // position is the center of the quad
+    void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+    void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+    // Atlas images share their page texture, so any number of them costs a single texture slot
+    void DrawQuad(const glm::vec2& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tint = glm::vec4(1.0f));
+
+    void ResetStats() { stats = BatchStats(); vertexBuffer.ResetStats(); }
+    const BatchStats& GetStats() const { return stats; }
+    const StreamBufferStats& GetStreamStats() const { return vertexBuffer.GetStats(); }
+
+private:
+    static constexpr unsigned int MaxTextureSlots = 16;
+
+    void Flush();
+    void ReserveQuad();
+    void PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex,
+        const glm::vec2& uvMin = glm::vec2(0.0f), const glm::vec2& uvMax = glm::vec2(1.0f));
+    float GetTextureSlot(const Texture& texture);
+
+    static std::vector<unsigned int> BuildQuadIndices(unsigned int maxQuads);
+
+    unsigned int maxQuads;
+    std::vector<QuadVertex> vertices;
+    std::array<const Texture*, MaxTextureSlots> textureSlots;
+    unsigned int textureSlotCount;
+
+    VertexArray vertexArray;
+    StreamBuffer vertexBuffer;
+    IndexBuffer indexBuffer;
+    Shader shader;
+    BatchStats stats;
+};
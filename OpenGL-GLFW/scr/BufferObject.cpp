@@ -0,0 +1,205 @@
+﻿#include "BufferObject.h"
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+BufferObject::BufferObject(unsigned int target, const void* data, unsigned int size, BufferUsage usage)
+    : target(target), rendererId(0), size(data ? size : 0), capacity(size), usage(usage), mapped(false)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &rendererId))
+        GLCall(glNamedBufferData(rendererId, size, data, GetGLUsage(usage)))
+        return;
+    }
+
+    // same as Update(), creating an index buffer must not replace the bound vertex array's element buffer
+    GLCall(glGenBuffers(1, &rendererId))
+    GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, data, GetGLUsage(usage)))
+}
+
+BufferObject::~BufferObject()
+{
+    GLCall(glDeleteBuffers(1, &rendererId))
+    GLStateCache::OnBufferDeleted(rendererId);
+}
+
+void BufferObject::Bind() const
+{
+    GLStateCache::BindBuffer(target, rendererId);
+}
+
+void BufferObject::Unbind() const
+{
+    GLStateCache::BindBuffer(target, 0);
+}
+
+void BufferObject::Update(unsigned int offset, const void* data, unsigned int size)
+{
+    ASSERT(!mapped)
+
+    if (offset + size > capacity)
+    {
+        // grow geometrically so appending every frame does not reallocate every frame
+        Reserve(offset + size > capacity * 2 ? offset + size : capacity * 2);
+    }
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glNamedBufferSubData(rendererId, offset, size, data))
+    }
+    else
+    {
+        // GL_COPY_WRITE_BUFFER instead of target, so updating an index buffer does not replace the
+        // element buffer of whatever vertex array happens to be bound
+        GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data))
+    }
+
+    if (offset + size > this->size)
+    {
+        this->size = offset + size;
+    }
+}
+
+void BufferObject::Orphan()
+{
+    ASSERT(!mapped)
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glNamedBufferData(rendererId, capacity, nullptr, GetGLUsage(usage)))
+    }
+    else
+    {
+        GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GetGLUsage(usage)))
+    }
+
+    size = 0;
+}
+
+void BufferObject::Reserve(unsigned int capacity)
+{
+    ASSERT(!mapped)
+
+    if (capacity <= this->capacity)
+    {
+        return;
+    }
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        ReserveNamed(capacity);
+        return;
+    }
+
+    // glBufferData on the same name drops the contents, park them in a scratch buffer meanwhile
+    unsigned int scratch = 0;
+    if (size > 0)
+    {
+        GLCall(glGenBuffers(1, &scratch))
+        GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_COPY))
+        GLStateCache::BindBuffer(GL_COPY_READ_BUFFER, rendererId);
+        GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size))
+    }
+
+    GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GetGLUsage(usage)))
+    this->capacity = capacity;
+
+    if (scratch != 0)
+    {
+        GLStateCache::BindBuffer(GL_COPY_READ_BUFFER, scratch);
+        GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size))
+        GLCall(glDeleteBuffers(1, &scratch))
+        GLStateCache::OnBufferDeleted(scratch);
+    }
+}
+
+void* BufferObject::Map()
+{
+    return MapRange(0, capacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+void* BufferObject::MapRange(unsigned int offset, unsigned int size, unsigned int access)
+{
+    ASSERT(!mapped)
+    ASSERT(offset + size <= capacity)
+
+    void* data = nullptr;
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(data = glMapNamedBufferRange(rendererId, offset, size, access))
+    }
+    else
+    {
+        GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+        GLCall(data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, access))
+    }
+
+    mapped = data != nullptr;
+
+    // whatever gets written through the pointer counts as contents
+    if ((access & GL_MAP_WRITE_BIT) && offset + size > this->size)
+    {
+        this->size = offset + size;
+    }
+
+    return data;
+}
+
+void BufferObject::Unmap()
+{
+    ASSERT(mapped)
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glUnmapNamedBuffer(rendererId))
+    }
+    else
+    {
+        GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, rendererId);
+        GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER))
+    }
+
+    mapped = false;
+}
+
+void BufferObject::ReserveNamed(unsigned int capacity)
+{
+    unsigned int scratch = 0;
+    if (size > 0)
+    {
+        GLCall(glCreateBuffers(1, &scratch))
+        GLCall(glNamedBufferData(scratch, size, nullptr, GL_STREAM_COPY))
+        GLCall(glCopyNamedBufferSubData(rendererId, scratch, 0, 0, size))
+    }
+
+    GLCall(glNamedBufferData(rendererId, capacity, nullptr, GetGLUsage(usage)))
+    this->capacity = capacity;
+
+    if (scratch != 0)
+    {
+        GLCall(glCopyNamedBufferSubData(scratch, rendererId, 0, 0, size))
+        GLCall(glDeleteBuffers(1, &scratch))
+    }
+}
+
+unsigned int BufferObject::GetGLUsage(BufferUsage usage)
+{
+    switch (usage)
+    {
+        case BufferUsage::Static:
+            return GL_STATIC_DRAW;
+        case BufferUsage::Dynamic:
+            return GL_DYNAMIC_DRAW;
+        case BufferUsage::Stream:
+            return GL_STREAM_DRAW;
+    }
+
+    ASSERT(false)
+    return GL_STATIC_DRAW;
+}
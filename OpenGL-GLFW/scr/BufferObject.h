@@ -0,0 +1,59 @@
+﻿#pragma once
+
+enum class BufferUsage
+{
+    // uploaded once, drawn many times
+    Static = 0,
+    // updated now and then, drawn many times
+    Dynamic,
+    // rewritten about every time it is drawn
+    Stream,
+};
+
+// Storage shared by VertexBuffer and IndexBuffer. The GL name never changes, growing reallocates
+// the same buffer object, so vertex arrays referencing it stay valid.
+class BufferObject
+{
+public:
+    BufferObject(unsigned int target, const void* data, unsigned int size, BufferUsage usage);
+    ~BufferObject();
+
+    BufferObject(const BufferObject&) = delete;
+    BufferObject& operator=(const BufferObject&) = delete;
+
+    void Bind() const;
+    void Unbind() const;
+
+    // Writes size bytes at offset, growing the capacity first when they do not fit
+    void Update(unsigned int offset, const void* data, unsigned int size);
+    // Hands the old storage to the driver and starts over empty, so the next writes do not wait on
+    // draws still reading the previous contents
+    void Orphan();
+    // Grows to at least capacity bytes, keeping the contents
+    void Reserve(unsigned int capacity);
+
+    // Maps the whole capacity for writing, discarding the old contents
+    void* Map();
+    // access is a combination of GL_MAP_*_BIT, the range must lie inside the capacity
+    void* MapRange(unsigned int offset, unsigned int size, unsigned int access);
+    void Unmap();
+
+    unsigned int GetRendererId() const { return rendererId; }
+    // bytes written so far, never more than the capacity
+    unsigned int GetSize() const { return size; }
+    unsigned int GetCapacity() const { return capacity; }
+    BufferUsage GetUsage() const { return usage; }
+
+    static unsigned int GetGLUsage(BufferUsage usage);
+
+protected:
+    // Reserve through direct state access, nothing gets bound
+    void ReserveNamed(unsigned int capacity);
+
+    unsigned int target;
+    unsigned int rendererId;
+    unsigned int size;
+    unsigned int capacity;
+    BufferUsage usage;
+    bool mapped;
+};
@@ -0,0 +1,19 @@
+﻿#include "CameraBuffer.h"
+
+static_assert(sizeof(CameraUniforms) == 3 * 64 + 16 + 16, "CameraUniforms must match the std140 Camera block");
+
+CameraBuffer::CameraBuffer()
+    : uniformBuffer(sizeof(CameraUniforms), BindingPoint), uniforms()
+{
+}
+
+void CameraBuffer::Update(const glm::mat4x4& view, const glm::mat4x4& projection, const glm::vec4& viewport, float time)
+{
+    uniforms.view = view;
+    uniforms.projection = projection;
+    uniforms.viewProjection = projection * view;
+    uniforms.viewport = viewport;
+    uniforms.time = time;
+
+    uniformBuffer.SetData(&uniforms, sizeof(CameraUniforms));
+}
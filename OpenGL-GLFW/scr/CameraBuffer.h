@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <GLM/glm.hpp>
+
+#include "UniformBuffer.h"
+
+// std140 layout of the Camera block, every member is 16 byte aligned so the C++ struct matches as is
+struct CameraUniforms
+{
+    glm::mat4x4 view;
+    glm::mat4x4 projection;
+    glm::mat4x4 viewProjection;
+    // x, y, width, height in pixels
+    glm::vec4 viewport;
+    float time;
+    float padding[3];
+};
+
+// Per frame camera data shared by every shader that declares
+//
+//     layout(std140) uniform Camera { mat4 u_View; mat4 u_Projection; mat4 u_ViewProjection; vec4 u_Viewport; float u_Time; };
+//
+// Shader links such a block to BindingPoint on its own, so draws only have to upload their model matrix.
+class CameraBuffer
+{
+public:
+    static constexpr unsigned int BindingPoint = 0;
+    static constexpr const char* BlockName = "Camera";
+
+    CameraBuffer();
+    ~CameraBuffer() = default;
+
+    // Call once per frame before drawing
+    void Update(const glm::mat4x4& view, const glm::mat4x4& projection, const glm::vec4& viewport, float time);
+
+    const CameraUniforms& GetUniforms() const { return uniforms; }
+
+private:
+    UniformBuffer uniformBuffer;
+    CameraUniforms uniforms;
+};
@@ -0,0 +1,15 @@
+﻿#include "CommandList.h"
+
+#include "RenderQueue.h"
+
+void CommandList::Draw(const DrawPacket& packet, RenderPass pass, bool translucent, float depth)
+{
+    commands.push_back({ RenderQueue::MakeKey(packet, pass, translucent, depth), static_cast<unsigned int>(packets.size()) });
+    packets.push_back(packet);
+}
+
+void CommandList::Clear()
+{
+    commands.clear();
+    packets.clear();
+}
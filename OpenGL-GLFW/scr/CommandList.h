@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+
+enum class RenderPass : unsigned char
+{
+    Opaque = 0,
+    Translucent,
+    Overlay,
+};
+
+// Everything needed to execute a draw, kept apart from the key so sorting only moves 16 bytes per command
+struct DrawPacket
+{
+    const VertexArray* vertexArray;
+    const IndexBuffer* indexBuffer;
+    Shader* shader;
+    const Texture* texture;
+    glm::mat4x4 model;
+};
+
+struct RenderCommand
+{
+    uint64_t key;
+    unsigned int packetIndex;
+};
+
+// Records draws without touching GL, so any thread can fill one while the GL thread is busy.
+// A RenderQueue merges and executes them.
+class CommandList
+{
+public:
+    CommandList() = default;
+    ~CommandList() = default;
+
+    // depth is expected in [0, 1], 0 being closest to the camera
+    void Draw(const DrawPacket& packet, RenderPass pass, bool translucent, float depth);
+    void Clear();
+
+    const std::vector<RenderCommand>& GetCommands() const { return commands; }
+    const std::vector<DrawPacket>& GetPackets() const { return packets; }
+
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<DrawPacket> packets;
+};
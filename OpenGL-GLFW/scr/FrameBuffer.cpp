@@ -0,0 +1,115 @@
+﻿#include "FrameBuffer.h"
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+FrameBuffer::FrameBuffer()
+    : rendererId(0)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateFramebuffers(1, &rendererId))
+        return;
+    }
+
+    GLCall(glGenFramebuffers(1, &rendererId))
+}
+
+FrameBuffer::~FrameBuffer()
+{
+    GLCall(glDeleteFramebuffers(1, &rendererId))
+    GLStateCache::OnFramebufferDeleted(rendererId);
+}
+
+void FrameBuffer::Bind() const
+{
+    GLStateCache::BindFramebuffer(rendererId);
+}
+
+void FrameBuffer::Unbind() const
+{
+    GLStateCache::BindFramebuffer(0);
+}
+
+void FrameBuffer::Attach(unsigned int attachment, unsigned int texture)
+{
+    if (attachment >= GL_COLOR_ATTACHMENT0 && attachment <= GL_COLOR_ATTACHMENT15)
+    {
+        drawBuffers.push_back(attachment);
+    }
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glNamedFramebufferTexture(rendererId, attachment, texture, 0))
+    }
+    else
+    {
+        Bind();
+        GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0))
+    }
+
+    UpdateDrawBuffers();
+}
+
+bool FrameBuffer::IsComplete() const
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(const unsigned int status = glCheckNamedFramebufferStatus(rendererId, GL_FRAMEBUFFER))
+        return status == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    Bind();
+    GLCall(const unsigned int status = glCheckFramebufferStatus(GL_FRAMEBUFFER))
+
+    return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void FrameBuffer::Invalidate(const std::vector<unsigned int>& attachments) const
+{
+    if (!GLEW_ARB_invalidate_subdata || attachments.empty())
+    {
+        return;
+    }
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glInvalidateNamedFramebufferData(rendererId, static_cast<int>(attachments.size()), attachments.data()))
+        return;
+    }
+
+    Bind();
+    GLCall(glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<int>(attachments.size()), attachments.data()))
+}
+
+void FrameBuffer::UpdateDrawBuffers() const
+{
+    // without color attachments the default GL_COLOR_ATTACHMENT0 draw and read buffers
+    // would point at nothing, which leaves a depth only frame buffer incomplete on 3.3
+    const unsigned int readBuffer = drawBuffers.empty() ? GL_NONE : drawBuffers.front();
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        if (drawBuffers.empty())
+        {
+            GLCall(glNamedFramebufferDrawBuffer(rendererId, GL_NONE))
+        }
+        else
+        {
+            GLCall(glNamedFramebufferDrawBuffers(rendererId, static_cast<int>(drawBuffers.size()), drawBuffers.data()))
+        }
+        GLCall(glNamedFramebufferReadBuffer(rendererId, readBuffer))
+        return;
+    }
+
+    Bind();
+    if (drawBuffers.empty())
+    {
+        GLCall(glDrawBuffer(GL_NONE))
+    }
+    else
+    {
+        GLCall(glDrawBuffers(static_cast<int>(drawBuffers.size()), drawBuffers.data()))
+    }
+    GLCall(glReadBuffer(readBuffer))
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <vector>
+
+class FrameBuffer
+{
+public:
+    FrameBuffer();
+    ~FrameBuffer();
+
+    void Bind() const;
+    void Unbind() const;
+
+    // attachment is GL_COLOR_ATTACHMENTi, GL_DEPTH_ATTACHMENT or GL_DEPTH_STENCIL_ATTACHMENT
+    void Attach(unsigned int attachment, unsigned int texture);
+    bool IsComplete() const;
+
+    // Tells the driver the contents of these attachments are not needed anymore,
+    // so tiled GPUs can skip storing them. No-op without ARB_invalidate_subdata.
+    void Invalidate(const std::vector<unsigned int>& attachments) const;
+
+    unsigned int GetRendererId() const { return rendererId; }
+
+private:
+    void UpdateDrawBuffers() const;
+
+    unsigned int rendererId;
+    std::vector<unsigned int> drawBuffers;
+};
@@ -0,0 +1,393 @@
+﻿#include "FrameGraph.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+FrameGraphResource FrameGraphBuilder::Create(const std::string& name, const RenderTargetDesc& desc)
+{
+    const FrameGraphResource resource = static_cast<FrameGraphResource>(graph.resources.size());
+    graph.resources.push_back({ name, desc, passIndex, resource, 0, 0, false, -1, 0, 0 });
+    graph.passes[passIndex].writes.push_back(resource);
+
+    return resource;
+}
+
+FrameGraphResource FrameGraphBuilder::Read(FrameGraphResource resource)
+{
+    ASSERT(resource < graph.resources.size())
+
+    graph.passes[passIndex].reads.push_back(resource);
+    return resource;
+}
+
+FrameGraphResource FrameGraphBuilder::Write(FrameGraphResource resource)
+{
+    ASSERT(resource < graph.resources.size())
+
+    FrameGraph::ResourceNode node = graph.resources[resource];
+    node.writer = passIndex;
+    node.version++;
+    node.output = false;
+
+    const FrameGraphResource written = static_cast<FrameGraphResource>(graph.resources.size());
+    graph.resources.push_back(std::move(node));
+    graph.passes[passIndex].writes.push_back(written);
+    return written;
+}
+
+void FrameGraphBuilder::WriteBackbuffer()
+{
+    graph.passes[passIndex].writesBackbuffer = true;
+}
+
+FrameGraph::FrameGraph(int backbufferWidth, int backbufferHeight)
+    : backbufferWidth(backbufferWidth), backbufferHeight(backbufferHeight)
+{
+}
+
+void FrameGraph::AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+{
+    const unsigned int passIndex = static_cast<unsigned int>(passes.size());
+    passes.push_back({ name, std::move(execute), {}, {}, 0, false, false, nullptr, {}, {} });
+
+    FrameGraphBuilder builder(*this, passIndex);
+    setup(builder);
+
+    // a pass renders either to the screen or to its own targets
+    ASSERT(!(passes[passIndex].writesBackbuffer && !passes[passIndex].writes.empty()))
+}
+
+void FrameGraph::MarkOutput(FrameGraphResource resource)
+{
+    ASSERT(resource < resources.size())
+
+    resources[resource].output = true;
+}
+
+void FrameGraph::Compile()
+{
+    stats = FrameGraphStats();
+    stats.passes = static_cast<unsigned int>(passes.size());
+    stats.transientResources = static_cast<unsigned int>(std::count_if(resources.begin(), resources.end(), [](const ResourceNode& resource)
+    {
+        return resource.version == 0;
+    }));
+
+    CullPasses();
+    AssignPhysicalTargets();
+    BuildFrameBuffers();
+
+    stats.physicalTargets = static_cast<unsigned int>(physicalTargets.size());
+}
+
+void FrameGraph::Execute()
+{
+    for (const PassNode& pass : passes)
+    {
+        if (pass.culled)
+        {
+            continue;
+        }
+
+        if (pass.frameBuffer)
+        {
+            const RenderTargetDesc& desc = resources[pass.writes.front()].desc;
+            pass.frameBuffer->Bind();
+            GLCall(glViewport(0, 0, desc.width, desc.height))
+
+            pass.frameBuffer->Invalidate(pass.discardBefore);
+        }
+        else
+        {
+            GLStateCache::BindFramebuffer(0);
+            GLCall(glViewport(0, 0, backbufferWidth, backbufferHeight))
+        }
+
+        pass.execute(*this);
+
+        if (pass.frameBuffer)
+        {
+            pass.frameBuffer->Invalidate(pass.discardAfter);
+        }
+    }
+
+    GLStateCache::BindFramebuffer(0);
+    GLCall(glViewport(0, 0, backbufferWidth, backbufferHeight))
+}
+
+void FrameGraph::Reset()
+{
+    ReleaseUnusedTargets();
+
+    passes.clear();
+    resources.clear();
+}
+
+void FrameGraph::SetBackbufferSize(int width, int height)
+{
+    backbufferWidth = width;
+    backbufferHeight = height;
+}
+
+const Texture& FrameGraph::GetTexture(FrameGraphResource resource) const
+{
+    ASSERT(resource < resources.size() && resources[resource].physicalTarget >= 0)
+
+    return *physicalTargets[resources[resource].physicalTarget].texture;
+}
+
+void FrameGraph::CullPasses()
+{
+    for (PassNode& pass : passes)
+    {
+        pass.refCount = static_cast<unsigned int>(pass.writes.size()) + (pass.writesBackbuffer ? 1 : 0);
+        pass.culled = false;
+    }
+
+    for (ResourceNode& resource : resources)
+    {
+        resource.refCount = resource.output ? 1 : 0;
+    }
+
+    for (const PassNode& pass : passes)
+    {
+        for (FrameGraphResource read : pass.reads)
+        {
+            resources[read].refCount++;
+        }
+    }
+
+    std::vector<FrameGraphResource> unreferenced;
+    for (FrameGraphResource resource = 0; resource < resources.size(); resource++)
+    {
+        if (resources[resource].refCount == 0)
+        {
+            unreferenced.push_back(resource);
+        }
+    }
+
+    // walk back from every version nobody reads, dropping producers that end up with no consumers.
+    // Each version has a single writer, so a pass reading what it writes never counts as its own consumer.
+    while (!unreferenced.empty())
+    {
+        const FrameGraphResource resource = unreferenced.back();
+        unreferenced.pop_back();
+
+        PassNode& pass = passes[resources[resource].writer];
+        if (pass.culled || --pass.refCount > 0)
+        {
+            continue;
+        }
+
+        pass.culled = true;
+        stats.culledPasses++;
+
+        for (FrameGraphResource read : pass.reads)
+        {
+            if (--resources[read].refCount == 0)
+            {
+                unreferenced.push_back(read);
+            }
+        }
+    }
+}
+
+void FrameGraph::AssignPhysicalTargets()
+{
+    const unsigned int noUse = static_cast<unsigned int>(passes.size());
+
+    for (ResourceNode& resource : resources)
+    {
+        resource.physicalTarget = -1;
+        resource.firstUse = noUse;
+        resource.lastUse = 0;
+    }
+
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+        if (passes[i].culled)
+        {
+            continue;
+        }
+
+        for (const auto* used : { &passes[i].reads, &passes[i].writes })
+        {
+            for (FrameGraphResource resource : *used)
+            {
+                ResourceNode& origin = resources[resources[resource].origin];
+                origin.firstUse = std::min(origin.firstUse, i);
+                origin.lastUse = std::max(origin.lastUse, i);
+            }
+        }
+    }
+
+    for (const ResourceNode& resource : resources)
+    {
+        // outputs have to survive the whole frame
+        ResourceNode& origin = resources[resource.origin];
+        if (resource.output && origin.firstUse != noUse)
+        {
+            origin.lastUse = noUse;
+        }
+    }
+
+    for (PhysicalTarget& target : physicalTargets)
+    {
+        target.busyUntil = -1;
+        target.usedThisFrame = false;
+    }
+
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+        for (ResourceNode& resource : resources)
+        {
+            if (resource.firstUse != i)
+            {
+                continue;
+            }
+
+            auto target = std::find_if(physicalTargets.begin(), physicalTargets.end(), [&](const PhysicalTarget& candidate)
+            {
+                return candidate.desc == resource.desc && candidate.busyUntil < static_cast<int>(i);
+            });
+
+            if (target == physicalTargets.end())
+            {
+                const RenderTargetDesc& desc = resource.desc;
+                physicalTargets.push_back({ desc, std::unique_ptr<Texture>(new Texture(desc.width, desc.height, desc.format)), -1, false });
+                target = physicalTargets.end() - 1;
+            }
+
+            target->busyUntil = static_cast<int>(resource.lastUse);
+            target->usedThisFrame = true;
+            resource.physicalTarget = static_cast<int>(target - physicalTargets.begin());
+        }
+    }
+
+    // only origins took part above, every later version lives in the same target
+    for (ResourceNode& resource : resources)
+    {
+        const ResourceNode& origin = resources[resource.origin];
+        resource.physicalTarget = origin.physicalTarget;
+        resource.firstUse = origin.firstUse;
+        resource.lastUse = origin.lastUse;
+    }
+}
+
+void FrameGraph::BuildFrameBuffers()
+{
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+        PassNode& pass = passes[i];
+        pass.frameBuffer = nullptr;
+        pass.discardBefore.clear();
+        pass.discardAfter.clear();
+
+        if (pass.culled || pass.writes.empty())
+        {
+            continue;
+        }
+
+        std::vector<unsigned int> textureIds;
+        std::vector<unsigned int> attachments;
+        unsigned int colorCount = 0;
+
+        for (FrameGraphResource write : pass.writes)
+        {
+            const ResourceNode& resource = resources[write];
+            unsigned int attachment = GL_COLOR_ATTACHMENT0 + colorCount;
+
+            if (resource.desc.format == GL_DEPTH24_STENCIL8)
+            {
+                attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+            }
+            else if (IsDepthFormat(resource.desc.format))
+            {
+                attachment = GL_DEPTH_ATTACHMENT;
+            }
+            else
+            {
+                colorCount++;
+            }
+
+            textureIds.push_back(physicalTargets[resource.physicalTarget].texture->GetRendererId());
+            attachments.push_back(attachment);
+
+            const bool readHere = std::any_of(pass.reads.begin(), pass.reads.end(), [&](FrameGraphResource read)
+            {
+                return resources[read].origin == resource.origin;
+            });
+            if (resource.firstUse == i && !readHere)
+            {
+                pass.discardBefore.push_back(attachment);
+            }
+
+            if (resource.lastUse == i)
+            {
+                pass.discardAfter.push_back(attachment);
+                stats.invalidatedAttachments++;
+            }
+        }
+
+        std::unique_ptr<FrameBuffer>& frameBuffer = frameBuffers[textureIds];
+        if (!frameBuffer)
+        {
+            frameBuffer.reset(new FrameBuffer());
+            for (unsigned int attachment = 0; attachment < attachments.size(); attachment++)
+            {
+                frameBuffer->Attach(attachments[attachment], textureIds[attachment]);
+            }
+
+            if (!frameBuffer->IsComplete())
+            {
+                std::cout << "WARNING: Frame buffer for pass '" << pass.name << "' is incomplete!\n";
+            }
+        }
+
+        pass.frameBuffer = frameBuffer.get();
+    }
+}
+
+void FrameGraph::ReleaseUnusedTargets()
+{
+    for (size_t i = physicalTargets.size(); i-- > 0;)
+    {
+        if (physicalTargets[i].usedThisFrame)
+        {
+            continue;
+        }
+
+        const unsigned int textureId = physicalTargets[i].texture->GetRendererId();
+        for (auto frameBuffer = frameBuffers.begin(); frameBuffer != frameBuffers.end();)
+        {
+            const std::vector<unsigned int>& textureIds = frameBuffer->first;
+            if (std::find(textureIds.begin(), textureIds.end(), textureId) != textureIds.end())
+            {
+                frameBuffer = frameBuffers.erase(frameBuffer);
+            }
+            else
+            {
+                ++frameBuffer;
+            }
+        }
+
+        physicalTargets.erase(physicalTargets.begin() + i);
+    }
+}
+
+bool FrameGraph::IsDepthFormat(unsigned int format)
+{
+    switch (format)
+    {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+            return true;
+    }
+
+    return false;
+}
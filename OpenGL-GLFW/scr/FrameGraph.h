@@ -0,0 +1,140 @@
+﻿#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameBuffer.h"
+#include "Texture.h"
+
+struct RenderTargetDesc
+{
+    int width;
+    int height;
+    unsigned int format;
+
+    bool operator==(const RenderTargetDesc& other) const
+    {
+        return width == other.width && height == other.height && format == other.format;
+    }
+};
+
+using FrameGraphResource = unsigned int;
+
+class FrameGraph;
+
+class FrameGraphBuilder
+{
+public:
+    // Transient target, only valid during the frame it was created in
+    FrameGraphResource Create(const std::string& name, const RenderTargetDesc& desc);
+    FrameGraphResource Read(FrameGraphResource resource);
+    // Returns a new version of the resource, later passes have to read that one to see this pass's output.
+    // The versions share one physical target, so a pass may read a version and write the next.
+    FrameGraphResource Write(FrameGraphResource resource);
+    // The pass draws to the default framebuffer, which also keeps it from being culled
+    void WriteBackbuffer();
+
+private:
+    friend class FrameGraph;
+
+    FrameGraphBuilder(FrameGraph& graph, unsigned int passIndex)
+        : graph(graph), passIndex(passIndex) {}
+
+    FrameGraph& graph;
+    unsigned int passIndex;
+};
+
+struct FrameGraphStats
+{
+    unsigned int passes = 0;
+    unsigned int culledPasses = 0;
+    unsigned int transientResources = 0;
+    unsigned int physicalTargets = 0;
+    unsigned int invalidatedAttachments = 0;
+};
+
+// Passes run in the order they were added. Compile() culls passes nothing depends on and lets
+// transient targets with the same description and non overlapping lifetimes share one texture.
+class FrameGraph
+{
+public:
+    using SetupFunction = std::function<void(FrameGraphBuilder& builder)>;
+    using ExecuteFunction = std::function<void(const FrameGraph& graph)>;
+
+    FrameGraph(int backbufferWidth, int backbufferHeight);
+    ~FrameGraph() = default;
+
+    void AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+    // Keeps the resource and its producers alive even if no pass reads it, e.g. to read it after Execute()
+    void MarkOutput(FrameGraphResource resource);
+
+    void Compile();
+    void Execute();
+    // Forgets passes and resources, the physical targets stay pooled for the next frame
+    void Reset();
+
+    void SetBackbufferSize(int width, int height);
+    const Texture& GetTexture(FrameGraphResource resource) const;
+    const FrameGraphStats& GetStats() const { return stats; }
+
+private:
+    friend class FrameGraphBuilder;
+
+    struct ResourceNode
+    {
+        std::string name;
+        RenderTargetDesc desc;
+        // the pass producing this version
+        unsigned int writer;
+        // the version Create() returned, lifetime and physical target are tracked there
+        FrameGraphResource origin;
+        unsigned int version;
+        unsigned int refCount;
+        bool output;
+        int physicalTarget;
+        unsigned int firstUse;
+        unsigned int lastUse;
+    };
+
+    struct PassNode
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<FrameGraphResource> reads;
+        std::vector<FrameGraphResource> writes;
+        unsigned int refCount;
+        bool writesBackbuffer;
+        bool culled;
+        FrameBuffer* frameBuffer;
+        std::vector<unsigned int> discardBefore;
+        std::vector<unsigned int> discardAfter;
+    };
+
+    struct PhysicalTarget
+    {
+        RenderTargetDesc desc;
+        std::unique_ptr<Texture> texture;
+        // index of the last pass using it this frame, -1 while free
+        int busyUntil;
+        bool usedThisFrame;
+    };
+
+    void CullPasses();
+    void AssignPhysicalTargets();
+    void BuildFrameBuffers();
+    void ReleaseUnusedTargets();
+
+    static bool IsDepthFormat(unsigned int format);
+
+    int backbufferWidth;
+    int backbufferHeight;
+    std::vector<PassNode> passes;
+    std::vector<ResourceNode> resources;
+    std::vector<PhysicalTarget> physicalTargets;
+    // keyed by the texture ids attached, in attachment order
+    std::map<std::vector<unsigned int>, std::unique_ptr<FrameBuffer>> frameBuffers;
+    FrameGraphStats stats;
+};
@@ -0,0 +1,302 @@
+﻿#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_USE_SSE 1
+#include <immintrin.h>
+#endif
+
+unsigned int SphereBounds::Add(const glm::vec3& center, float sphereRadius)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(sphereRadius);
+
+    return GetCount() - 1;
+}
+
+void SphereBounds::Set(unsigned int index, const glm::vec3& center, float sphereRadius)
+{
+    x[index] = center.x;
+    y[index] = center.y;
+    z[index] = center.z;
+    radius[index] = sphereRadius;
+}
+
+void SphereBounds::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+unsigned int AabbBounds::Add(const glm::vec3& min, const glm::vec3& max)
+{
+    centerX.push_back(0.0f);
+    centerY.push_back(0.0f);
+    centerZ.push_back(0.0f);
+    extentX.push_back(0.0f);
+    extentY.push_back(0.0f);
+    extentZ.push_back(0.0f);
+
+    const unsigned int index = GetCount() - 1;
+    Set(index, min, max);
+
+    return index;
+}
+
+void AabbBounds::Set(unsigned int index, const glm::vec3& min, const glm::vec3& max)
+{
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extent.x;
+    extentY[index] = extent.y;
+    extentZ[index] = extent.z;
+}
+
+void AabbBounds::Clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+Frustum::Frustum(const glm::mat4x4& viewProjection)
+{
+    // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    planes[4] = row3 + row2; // near
+    planes[5] = row3 - row2; // far
+
+    for (glm::vec4& plane : planes)
+    {
+        const float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+        {
+            plane /= length;
+        }
+    }
+}
+
+bool Frustum::IsVisible(const glm::vec3& center, float radius) const
+{
+    for (const glm::vec4& plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Frustum::Cull(const SphereBounds& bounds, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+    const float* x = bounds.x.data();
+    const float* y = bounds.y.data();
+    const float* z = bounds.z.data();
+    const float* r = bounds.radius.data();
+
+    // write straight into the output and trim afterwards, avoids a capacity check per object
+    size_t count = visible.size();
+    visible.resize(count + (end - begin));
+    unsigned int* output = visible.data();
+
+    unsigned int i = begin;
+
+#if defined(__AVX__)
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 px = _mm256_loadu_ps(x + i);
+        const __m256 py = _mm256_loadu_ps(y + i);
+        const __m256 pz = _mm256_loadu_ps(z + i);
+        const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            __m256 distance = _mm256_mul_ps(px, _mm256_set1_ps(plane.x));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(py, _mm256_set1_ps(plane.y)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(pz, _mm256_set1_ps(plane.z)));
+            distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (unsigned int lane = 0; lane < 8; lane++)
+        {
+            output[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+#if defined(FRUSTUM_USE_SSE)
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            __m128 distance = _mm_mul_ps(px, _mm_set1_ps(plane.x));
+            distance = _mm_add_ps(distance, _mm_mul_ps(py, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(pz, _mm_set1_ps(plane.z)));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (unsigned int lane = 0; lane < 4; lane++)
+        {
+            output[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        output[count] = i;
+        count += IsVisible(glm::vec3(x[i], y[i], z[i]), r[i]) ? 1 : 0;
+    }
+
+    visible.resize(count);
+}
+
+void Frustum::Cull(const AabbBounds& bounds, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+    const float* cx = bounds.centerX.data();
+    const float* cy = bounds.centerY.data();
+    const float* cz = bounds.centerZ.data();
+    const float* ex = bounds.extentX.data();
+    const float* ey = bounds.extentY.data();
+    const float* ez = bounds.extentZ.data();
+
+    size_t count = visible.size();
+    visible.resize(count + (end - begin));
+    unsigned int* output = visible.data();
+
+    unsigned int i = begin;
+
+#if defined(__AVX__)
+    const __m256 wideSignMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 px = _mm256_loadu_ps(cx + i);
+        const __m256 py = _mm256_loadu_ps(cy + i);
+        const __m256 pz = _mm256_loadu_ps(cz + i);
+        const __m256 qx = _mm256_loadu_ps(ex + i);
+        const __m256 qy = _mm256_loadu_ps(ey + i);
+        const __m256 qz = _mm256_loadu_ps(ez + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            const __m256 a = _mm256_set1_ps(plane.x);
+            const __m256 b = _mm256_set1_ps(plane.y);
+            const __m256 c = _mm256_set1_ps(plane.z);
+
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(px, a), _mm256_set1_ps(plane.w));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(py, b));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(pz, c));
+
+            __m256 radius = _mm256_mul_ps(qx, _mm256_and_ps(a, wideSignMask));
+            radius = _mm256_add_ps(radius, _mm256_mul_ps(qy, _mm256_and_ps(b, wideSignMask)));
+            radius = _mm256_add_ps(radius, _mm256_mul_ps(qz, _mm256_and_ps(c, wideSignMask)));
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (unsigned int lane = 0; lane < 8; lane++)
+        {
+            output[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+#if defined(FRUSTUM_USE_SSE)
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 px = _mm_loadu_ps(cx + i);
+        const __m128 py = _mm_loadu_ps(cy + i);
+        const __m128 pz = _mm_loadu_ps(cz + i);
+        const __m128 qx = _mm_loadu_ps(ex + i);
+        const __m128 qy = _mm_loadu_ps(ey + i);
+        const __m128 qz = _mm_loadu_ps(ez + i);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : planes)
+        {
+            const __m128 a = _mm_set1_ps(plane.x);
+            const __m128 b = _mm_set1_ps(plane.y);
+            const __m128 c = _mm_set1_ps(plane.z);
+
+            __m128 distance = _mm_add_ps(_mm_mul_ps(px, a), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(py, b));
+            distance = _mm_add_ps(distance, _mm_mul_ps(pz, c));
+
+            // projected radius of the box onto the plane normal
+            __m128 radius = _mm_mul_ps(qx, _mm_and_ps(a, signMask));
+            radius = _mm_add_ps(radius, _mm_mul_ps(qy, _mm_and_ps(b, signMask)));
+            radius = _mm_add_ps(radius, _mm_mul_ps(qz, _mm_and_ps(c, signMask)));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (unsigned int lane = 0; lane < 4; lane++)
+        {
+            output[count] = i + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        bool inside = true;
+        for (const glm::vec4& plane : planes)
+        {
+            const float distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+            const float radius = std::fabs(plane.x) * ex[i] + std::fabs(plane.y) * ey[i] + std::fabs(plane.z) * ez[i];
+            if (distance + radius < 0.0f)
+            {
+                inside = false;
+                break;
+            }
+        }
+
+        output[count] = i;
+        count += inside ? 1 : 0;
+    }
+
+    visible.resize(count);
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+// Bounds are kept as structure of arrays so the culling loops can load 4 (SSE) or 8 (AVX) objects at once
+struct SphereBounds
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+
+    unsigned int Add(const glm::vec3& center, float sphereRadius);
+    void Set(unsigned int index, const glm::vec3& center, float sphereRadius);
+    void Clear();
+    unsigned int GetCount() const { return static_cast<unsigned int>(x.size()); }
+};
+
+struct AabbBounds
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    unsigned int Add(const glm::vec3& min, const glm::vec3& max);
+    void Set(unsigned int index, const glm::vec3& min, const glm::vec3& max);
+    void Clear();
+    unsigned int GetCount() const { return static_cast<unsigned int>(centerX.size()); }
+};
+
+class Frustum
+{
+public:
+    // Planes point inwards, extracted from the clip space of projection * view (Gribb/Hartmann)
+    Frustum(const glm::mat4x4& viewProjection);
+
+    // Appends the indices in [begin, end) that intersect the frustum to visible
+    void Cull(const SphereBounds& bounds, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+    void Cull(const AabbBounds& bounds, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+
+    void Cull(const SphereBounds& bounds, std::vector<unsigned int>& visible) const { Cull(bounds, 0, bounds.GetCount(), visible); }
+    void Cull(const AabbBounds& bounds, std::vector<unsigned int>& visible) const { Cull(bounds, 0, bounds.GetCount(), visible); }
+
+    bool IsVisible(const glm::vec3& center, float radius) const;
+    const glm::vec4& GetPlane(unsigned int index) const { return planes[index]; }
+
+private:
+    glm::vec4 planes[6];
+};
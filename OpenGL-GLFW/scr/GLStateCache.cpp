@@ -0,0 +1,320 @@
+﻿#include "GLStateCache.h"
+
+#include "Renderer.h"
+
+namespace
+{
+    constexpr unsigned int Unknown = 0xFFFFFFFF;
+    constexpr unsigned int MaxTextureSlots = 32;
+
+    enum BufferTarget
+    {
+        ArrayBuffer = 0,
+        ElementArrayBuffer,
+        UniformBuffer,
+        DrawIndirectBuffer,
+        PixelUnpackBuffer,
+        BufferTargetCount,
+    };
+
+    enum TextureTarget
+    {
+        Texture2D = 0,
+        Texture2DArray,
+        TextureBuffer,
+        TextureTargetCount,
+    };
+
+    struct GLState
+    {
+        unsigned int program = Unknown;
+        unsigned int vertexArray = Unknown;
+        unsigned int buffers[BufferTargetCount];
+        unsigned int textures[MaxTextureSlots][TextureTargetCount];
+        unsigned int activeTextureSlot = Unknown;
+        unsigned int framebuffer = Unknown;
+
+        unsigned int blend = Unknown;
+        unsigned int blendSource = Unknown;
+        unsigned int blendDestination = Unknown;
+        unsigned int depthTest = Unknown;
+        unsigned int depthMask = Unknown;
+        unsigned int depthFunc = Unknown;
+
+        GLState()
+        {
+            for (unsigned int& buffer : buffers)
+            {
+                buffer = Unknown;
+            }
+
+            for (auto& slot : textures)
+            {
+                for (unsigned int& texture : slot)
+                {
+                    texture = Unknown;
+                }
+            }
+        }
+    };
+
+    GLState state;
+    GLStateStats stats;
+
+    int GetBufferTargetIndex(unsigned int target)
+    {
+        switch (target)
+        {
+            case GL_ARRAY_BUFFER:
+                return ArrayBuffer;
+            case GL_ELEMENT_ARRAY_BUFFER:
+                return ElementArrayBuffer;
+            case GL_UNIFORM_BUFFER:
+                return UniformBuffer;
+            case GL_DRAW_INDIRECT_BUFFER:
+                return DrawIndirectBuffer;
+            case GL_PIXEL_UNPACK_BUFFER:
+                return PixelUnpackBuffer;
+        }
+
+        return -1;
+    }
+
+    int GetTextureTargetIndex(unsigned int target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:
+                return Texture2D;
+            case GL_TEXTURE_2D_ARRAY:
+                return Texture2DArray;
+            case GL_TEXTURE_BUFFER:
+                return TextureBuffer;
+        }
+
+        return -1;
+    }
+
+    // Returns true when the caller has to issue the GL call
+    bool Update(unsigned int& cached, unsigned int value)
+    {
+        if (cached == value)
+        {
+            stats.skipped++;
+            return false;
+        }
+
+        cached = value;
+        stats.issued++;
+        return true;
+    }
+
+    void SetCapability(unsigned int& cached, unsigned int capability, bool enabled)
+    {
+        if (!Update(cached, enabled ? 1 : 0))
+        {
+            return;
+        }
+
+        if (enabled)
+        {
+            GLCall(glEnable(capability))
+        }
+        else
+        {
+            GLCall(glDisable(capability))
+        }
+    }
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (Update(state.program, program))
+    {
+        GLCall(glUseProgram(program))
+    }
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (Update(state.vertexArray, vertexArray))
+    {
+        GLCall(glBindVertexArray(vertexArray))
+
+        // the element buffer binding belongs to the vertex array we just switched to
+        state.buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    const int index = GetBufferTargetIndex(target);
+    if (index < 0)
+    {
+        stats.issued++;
+        GLCall(glBindBuffer(target, buffer))
+        return;
+    }
+
+    if (Update(state.buffers[index], buffer))
+    {
+        GLCall(glBindBuffer(target, buffer))
+    }
+}
+
+void GLStateCache::BindTexture(unsigned int slot, unsigned int target, unsigned int texture)
+{
+    ASSERT(slot < MaxTextureSlots)
+
+    const int index = GetTextureTargetIndex(target);
+    unsigned int untracked = Unknown;
+    unsigned int& cached = index < 0 ? untracked : state.textures[slot][index];
+
+    if (cached == texture)
+    {
+        stats.skipped++;
+        return;
+    }
+
+    if (Update(state.activeTextureSlot, slot))
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot))
+    }
+
+    cached = texture;
+    stats.issued++;
+    GLCall(glBindTexture(target, texture))
+}
+
+void GLStateCache::BindFramebuffer(unsigned int framebuffer)
+{
+    if (Update(state.framebuffer, framebuffer))
+    {
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer))
+    }
+}
+
+unsigned int GLStateCache::GetActiveTextureSlot()
+{
+    if (state.activeTextureSlot == Unknown)
+    {
+        int activeTexture = GL_TEXTURE0;
+        GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture))
+        state.activeTextureSlot = static_cast<unsigned int>(activeTexture - GL_TEXTURE0);
+    }
+
+    return state.activeTextureSlot;
+}
+
+void GLStateCache::SetBlend(bool enabled)
+{
+    SetCapability(state.blend, GL_BLEND, enabled);
+}
+
+void GLStateCache::SetBlendFunc(unsigned int source, unsigned int destination)
+{
+    if (state.blendSource == source && state.blendDestination == destination)
+    {
+        stats.skipped++;
+        return;
+    }
+
+    state.blendSource = source;
+    state.blendDestination = destination;
+    stats.issued++;
+    GLCall(glBlendFunc(source, destination))
+}
+
+void GLStateCache::SetDepthTest(bool enabled)
+{
+    SetCapability(state.depthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GLStateCache::SetDepthMask(bool enabled)
+{
+    if (Update(state.depthMask, enabled ? 1 : 0))
+    {
+        GLCall(glDepthMask(enabled ? GL_TRUE : GL_FALSE))
+    }
+}
+
+void GLStateCache::SetDepthFunc(unsigned int function)
+{
+    if (Update(state.depthFunc, function))
+    {
+        GLCall(glDepthFunc(function))
+    }
+}
+
+void GLStateCache::OnProgramDeleted(unsigned int program)
+{
+    if (state.program == program)
+    {
+        state.program = Unknown;
+    }
+}
+
+void GLStateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+    if (state.vertexArray == vertexArray)
+    {
+        state.vertexArray = 0;
+        state.buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GLStateCache::OnBufferDeleted(unsigned int buffer)
+{
+    for (unsigned int& bound : state.buffers)
+    {
+        if (bound == buffer)
+        {
+            bound = 0;
+        }
+    }
+}
+
+void GLStateCache::OnTextureDeleted(unsigned int texture)
+{
+    for (auto& slot : state.textures)
+    {
+        for (unsigned int& bound : slot)
+        {
+            if (bound == texture)
+            {
+                bound = 0;
+            }
+        }
+    }
+}
+
+void GLStateCache::OnFramebufferDeleted(unsigned int framebuffer)
+{
+    if (state.framebuffer == framebuffer)
+    {
+        state.framebuffer = 0;
+    }
+}
+
+void GLStateCache::OnElementBufferChanged(unsigned int vertexArray)
+{
+    if (state.vertexArray == vertexArray)
+    {
+        state.buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GLStateCache::Invalidate()
+{
+    state = GLState();
+}
+
+const GLStateStats& GLStateCache::GetStats()
+{
+    return stats;
+}
+
+void GLStateCache::ResetStats()
+{
+    stats = GLStateStats();
+}
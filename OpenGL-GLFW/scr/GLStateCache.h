@@ -0,0 +1,41 @@
+﻿#pragma once
+
+struct GLStateStats
+{
+    unsigned int issued = 0;
+    unsigned int skipped = 0;
+};
+
+// Shadows the GL binding and fixed function state of the single context we render with
+// and drops calls that would set a value that is already current
+class GLStateCache
+{
+public:
+    static void UseProgram(unsigned int program);
+    static void BindVertexArray(unsigned int vertexArray);
+    static void BindBuffer(unsigned int target, unsigned int buffer);
+    static void BindTexture(unsigned int slot, unsigned int target, unsigned int texture);
+    static void BindFramebuffer(unsigned int framebuffer);
+    static unsigned int GetActiveTextureSlot();
+
+    static void SetBlend(bool enabled);
+    static void SetBlendFunc(unsigned int source, unsigned int destination);
+    static void SetDepthTest(bool enabled);
+    static void SetDepthMask(bool enabled);
+    static void SetDepthFunc(unsigned int function);
+
+    // GL drops bindings of deleted objects on its own, the cache has to follow
+    static void OnProgramDeleted(unsigned int program);
+    static void OnVertexArrayDeleted(unsigned int vertexArray);
+    static void OnBufferDeleted(unsigned int buffer);
+    static void OnTextureDeleted(unsigned int texture);
+    static void OnFramebufferDeleted(unsigned int framebuffer);
+    // Direct state access changed the element buffer of a vertex array without binding it
+    static void OnElementBufferChanged(unsigned int vertexArray);
+
+    // Forget everything, call after code outside of the wrappers changed GL state
+    static void Invalidate();
+
+    static const GLStateStats& GetStats();
+    static void ResetStats();
+};
@@ -1,27 +1,16 @@
 ﻿#include "IndexBuffer.h"
 #include "Renderer.h"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    : count(count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage)
+    : BufferObject(GL_ELEMENT_ARRAY_BUFFER, data, count * sizeof(unsigned int), usage),
+      indexType(GL_UNSIGNED_INT), indexSize(sizeof(unsigned int))
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint))
-    
-    GLCall(glGenBuffers(1, &rendererId))
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererId))
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW))
 }
 
-IndexBuffer::~IndexBuffer()
+IndexBuffer::IndexBuffer(const unsigned short* data, unsigned int count, BufferUsage usage)
+    : BufferObject(GL_ELEMENT_ARRAY_BUFFER, data, count * sizeof(unsigned short), usage),
+      indexType(GL_UNSIGNED_SHORT), indexSize(sizeof(unsigned short))
 {
-    GLCall(glDeleteBuffers(1, &rendererId))
-}
-
-void IndexBuffer::Bind() const
-{
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererId))
-}
-
-void IndexBuffer::Unbind() const
-{
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0))
+    ASSERT(sizeof(unsigned short) == sizeof(GLushort))
 }
@@ -1,17 +1,22 @@
 ﻿#pragma once
 
-class IndexBuffer
+#include "BufferObject.h"
+
+class IndexBuffer : public BufferObject
 {
 public:
-    IndexBuffer(const unsigned int* data, unsigned int count);
-    ~IndexBuffer();
+    IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
+    // 16 bit indices halve the index bandwidth of meshes with at most 65536 vertices
+    IndexBuffer(const unsigned short* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
+    ~IndexBuffer() = default;
 
-    void Bind() const;
-    void Unbind() const;
+    // indices written so far
+    unsigned int GetCount() const { return size / indexSize; }
+    // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT, as expected by the glDrawElements family
+    unsigned int GetIndexType() const { return indexType; }
+    unsigned int GetIndexSize() const { return indexSize; }
 
-    unsigned int GetCount() const { return count; }
-    
 private:
-    unsigned int rendererId;
-    unsigned int count;
+    unsigned int indexType;
+    unsigned int indexSize;
 };
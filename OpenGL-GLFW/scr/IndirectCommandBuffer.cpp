@@ -0,0 +1,82 @@
+﻿#include "IndirectCommandBuffer.h"
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+IndirectCommandBuffer::IndirectCommandBuffer()
+    : rendererId(0), capacity(0)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &rendererId))
+        return;
+    }
+
+    GLCall(glGenBuffers(1, &rendererId))
+}
+
+IndirectCommandBuffer::~IndirectCommandBuffer()
+{
+    GLCall(glDeleteBuffers(1, &rendererId))
+    GLStateCache::OnBufferDeleted(rendererId);
+}
+
+unsigned int IndirectCommandBuffer::AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex)
+{
+    const unsigned int drawId = static_cast<unsigned int>(commands.size());
+    commands.push_back({ indexCount, 1, firstIndex, baseVertex, drawId });
+
+    return drawId;
+}
+
+void IndirectCommandBuffer::Clear()
+{
+    commands.clear();
+}
+
+void IndirectCommandBuffer::Upload()
+{
+    // without indirect draws the commands are replayed from the CPU copy
+    if (!Renderer::SupportsMultiDrawIndirect() || commands.empty())
+    {
+        return;
+    }
+
+    const unsigned int size = static_cast<unsigned int>(commands.size() * sizeof(DrawElementsIndirectCommand));
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        if (size > capacity)
+        {
+            capacity = size;
+            GLCall(glNamedBufferData(rendererId, capacity, commands.data(), GL_DYNAMIC_DRAW))
+        }
+        else
+        {
+            GLCall(glNamedBufferSubData(rendererId, 0, size, commands.data()))
+        }
+        return;
+    }
+
+    Bind();
+
+    if (size > capacity)
+    {
+        capacity = size;
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity, commands.data(), GL_DYNAMIC_DRAW))
+    }
+    else
+    {
+        GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data()))
+    }
+}
+
+void IndirectCommandBuffer::Bind() const
+{
+    GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, rendererId);
+}
+
+void IndirectCommandBuffer::Unbind() const
+{
+    GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
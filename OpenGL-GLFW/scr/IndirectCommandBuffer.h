@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include <vector>
+
+// Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+class IndirectCommandBuffer
+{
+public:
+    IndirectCommandBuffer();
+    ~IndirectCommandBuffer();
+
+    // Returns the draw id the shader sees for this draw, use it to index per draw data
+    unsigned int AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex);
+    void Clear();
+    void Upload();
+
+    void Bind() const;
+    void Unbind() const;
+
+    const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return commands; }
+    unsigned int GetCount() const { return static_cast<unsigned int>(commands.size()); }
+
+private:
+    unsigned int rendererId;
+    unsigned int capacity;
+    std::vector<DrawElementsIndirectCommand> commands;
+};
@@ -0,0 +1,215 @@
+﻿#include "LooseQuadTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Renderer.h"
+
+LooseQuadTree::LooseQuadTree(const glm::vec2& worldMin, const glm::vec2& worldMax, unsigned int depth)
+    : worldMin(worldMin), count(0)
+{
+    ASSERT(depth > 0 && depth <= 12)
+
+    // the grids are square, a non square world just leaves the far cells empty
+    worldSize = std::max(worldMax.x - worldMin.x, worldMax.y - worldMin.y);
+
+    levels.resize(depth);
+    for (unsigned int i = 0; i < depth; i++)
+    {
+        Level& level = levels[i];
+        level.resolution = 1u << i;
+        level.cellSize = worldSize / static_cast<float>(level.resolution);
+        level.count = 0;
+        level.cells.resize(level.resolution * level.resolution);
+    }
+}
+
+unsigned int LooseQuadTree::Insert(const glm::vec2& min, const glm::vec2& max, unsigned int userData)
+{
+    unsigned int handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<unsigned int>(items.size());
+        items.emplace_back();
+    }
+
+    Item& item = items[handle];
+    item.min = min;
+    item.max = max;
+    item.userData = userData;
+
+    Link(handle);
+    count++;
+
+    return handle;
+}
+
+void LooseQuadTree::Move(unsigned int handle, const glm::vec2& min, const glm::vec2& max)
+{
+    Item& item = items[handle];
+    item.min = min;
+    item.max = max;
+
+    int level;
+    unsigned int cell;
+    Locate(min, max, level, cell);
+
+    // most moves stay in the same loose cell and only need the new bounds
+    if (level == item.level && cell == item.cell)
+    {
+        return;
+    }
+
+    Unlink(handle);
+    Link(handle);
+}
+
+void LooseQuadTree::Remove(unsigned int handle)
+{
+    Unlink(handle);
+    freeHandles.push_back(handle);
+    count--;
+}
+
+void LooseQuadTree::Clear()
+{
+    for (Level& level : levels)
+    {
+        for (std::vector<unsigned int>& cell : level.cells)
+        {
+            cell.clear();
+        }
+
+        level.count = 0;
+    }
+
+    outside.clear();
+    items.clear();
+    freeHandles.clear();
+    count = 0;
+}
+
+void LooseQuadTree::QueryRect(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const
+{
+    const auto overlaps = [&](const Item& item)
+    {
+        return item.min.x <= max.x && item.max.x >= min.x && item.min.y <= max.y && item.max.y >= min.y;
+    };
+
+    for (unsigned int handle : outside)
+    {
+        if (overlaps(items[handle]))
+        {
+            results.push_back(items[handle].userData);
+        }
+    }
+
+    for (const Level& level : levels)
+    {
+        if (level.count == 0)
+        {
+            continue;
+        }
+
+        // a cell's loose bounds reach half a cell past its edges
+        const float margin = level.cellSize * 0.5f;
+        const float lastCell = static_cast<float>(level.resolution - 1);
+        const unsigned int beginX = static_cast<unsigned int>(glm::clamp(std::floor((min.x - margin - worldMin.x) / level.cellSize), 0.0f, lastCell));
+        const unsigned int beginY = static_cast<unsigned int>(glm::clamp(std::floor((min.y - margin - worldMin.y) / level.cellSize), 0.0f, lastCell));
+        const unsigned int endX = static_cast<unsigned int>(glm::clamp(std::floor((max.x + margin - worldMin.x) / level.cellSize), 0.0f, lastCell));
+        const unsigned int endY = static_cast<unsigned int>(glm::clamp(std::floor((max.y + margin - worldMin.y) / level.cellSize), 0.0f, lastCell));
+
+        for (unsigned int y = beginY; y <= endY; y++)
+        {
+            for (unsigned int x = beginX; x <= endX; x++)
+            {
+                for (unsigned int handle : level.cells[y * level.resolution + x])
+                {
+                    if (overlaps(items[handle]))
+                    {
+                        results.push_back(items[handle].userData);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LooseQuadTree::QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const
+{
+    QueryRect(point, point, results);
+}
+
+void LooseQuadTree::Link(unsigned int handle)
+{
+    Item& item = items[handle];
+    Locate(item.min, item.max, item.level, item.cell);
+
+    if (item.level >= 0)
+    {
+        levels[item.level].count++;
+    }
+
+    std::vector<unsigned int>& cell = GetCell(item.level, item.cell);
+    item.slot = static_cast<unsigned int>(cell.size());
+    cell.push_back(handle);
+}
+
+void LooseQuadTree::Unlink(unsigned int handle)
+{
+    const Item& item = items[handle];
+    std::vector<unsigned int>& cell = GetCell(item.level, item.cell);
+
+    // swap the last entry into the freed slot so removal stays O(1)
+    const unsigned int moved = cell.back();
+    cell[item.slot] = moved;
+    items[moved].slot = item.slot;
+    cell.pop_back();
+
+    if (item.level >= 0)
+    {
+        levels[item.level].count--;
+    }
+}
+
+void LooseQuadTree::Locate(const glm::vec2& min, const glm::vec2& max, int& level, unsigned int& cell) const
+{
+    const glm::vec2 center = (min + max) * 0.5f;
+
+    if (center.x < worldMin.x || center.y < worldMin.y || center.x >= worldMin.x + worldSize || center.y >= worldMin.y + worldSize)
+    {
+        level = -1;
+        cell = 0;
+        return;
+    }
+
+    // deepest level whose cells are at least as large as the object, which the loose margin can then hold
+    const float size = std::max(max.x - min.x, max.y - min.y);
+    const int deepest = static_cast<int>(levels.size()) - 1;
+    level = deepest;
+    if (size > 0.0f)
+    {
+        level = std::min(deepest, static_cast<int>(std::floor(std::log2(worldSize / size))));
+        level = std::max(level, 0);
+    }
+
+    const Level& grid = levels[level];
+    const unsigned int x = std::min(static_cast<unsigned int>((center.x - worldMin.x) / grid.cellSize), grid.resolution - 1);
+    const unsigned int y = std::min(static_cast<unsigned int>((center.y - worldMin.y) / grid.cellSize), grid.resolution - 1);
+    cell = y * grid.resolution + x;
+}
+
+std::vector<unsigned int>& LooseQuadTree::GetCell(int level, unsigned int cell)
+{
+    if (level < 0)
+    {
+        return outside;
+    }
+
+    return levels[level].cells[cell];
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+// Every level is a dense grid whose cells are loose by half a cell on each side, so an object only has
+// to fit by size and its cell follows directly from its center. Insert, Move and Remove are O(1).
+class LooseQuadTree
+{
+public:
+    LooseQuadTree(const glm::vec2& worldMin, const glm::vec2& worldMax, unsigned int depth = 8);
+    ~LooseQuadTree() = default;
+
+    // Returns a handle for Move/Remove, userData is what the queries report back
+    unsigned int Insert(const glm::vec2& min, const glm::vec2& max, unsigned int userData);
+    void Move(unsigned int handle, const glm::vec2& min, const glm::vec2& max);
+    void Remove(unsigned int handle);
+    void Clear();
+
+    // Appends the userData of every object overlapping the rect or containing the point
+    void QueryRect(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const;
+    void QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const;
+
+    unsigned int GetCount() const { return count; }
+
+private:
+    struct Item
+    {
+        glm::vec2 min;
+        glm::vec2 max;
+        unsigned int userData;
+        // level -1 holds objects centered outside the world, scanned by every query
+        int level;
+        unsigned int cell;
+        unsigned int slot;
+    };
+
+    struct Level
+    {
+        unsigned int resolution;
+        float cellSize;
+        unsigned int count;
+        std::vector<std::vector<unsigned int>> cells;
+    };
+
+    void Locate(const glm::vec2& min, const glm::vec2& max, int& level, unsigned int& cell) const;
+    void Link(unsigned int handle);
+    void Unlink(unsigned int handle);
+    std::vector<unsigned int>& GetCell(int level, unsigned int cell);
+
+    glm::vec2 worldMin;
+    float worldSize;
+    std::vector<Level> levels;
+    std::vector<unsigned int> outside;
+
+    std::vector<Item> items;
+    std::vector<unsigned int> freeHandles;
+    unsigned int count;
+};
@@ -0,0 +1,438 @@
+﻿#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include <GLM/glm.hpp>
+
+namespace
+{
+    constexpr unsigned int InvalidIndex = 0xFFFFFFFF;
+
+    // Forsyth's tuning values
+    constexpr int ForsythCacheSize = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    float GetVertexScore(int cachePosition, unsigned int remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // the three vertices of the triangle just emitted score the same, whatever their order
+            if (cachePosition < 3)
+            {
+                score = LastTriangleScore;
+            }
+            else
+            {
+                const float scaler = 1.0f / (ForsythCacheSize - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+            }
+        }
+
+        // vertices with few triangles left get finished first so they do not linger
+        score += ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+        return score;
+    }
+
+    glm::vec3 GetPosition(const MeshData& mesh, unsigned int vertex, unsigned int positionOffset, unsigned int positionComponents)
+    {
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        std::memcpy(position, &mesh.vertices[vertex * mesh.vertexStride + positionOffset], positionComponents * sizeof(float));
+        return { position[0], position[1], position[2] };
+    }
+
+    // Returns how many of the triangle's vertices missed the FIFO cache
+    unsigned int SimulateTriangle(std::vector<unsigned int>& timestamps, unsigned int& time, unsigned int cacheSize, const unsigned int* triangle)
+    {
+        unsigned int misses = 0;
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const unsigned int vertex = triangle[corner];
+            if (time - timestamps[vertex] > cacheSize)
+            {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+
+        return misses;
+    }
+}
+
+MeshOptimizationReport MeshOptimizer::Optimize(MeshData& mesh, unsigned int positionOffset, unsigned int positionComponents)
+{
+    MeshOptimizationReport report;
+    report.vertexCountBefore = mesh.GetVertexCount();
+    report.before = AnalyzeVertexCache(mesh.indices, mesh.GetVertexCount());
+
+    DeduplicateVertices(mesh);
+    OptimizeVertexCache(mesh.indices, mesh.GetVertexCount());
+    OptimizeOverdraw(mesh, positionOffset, positionComponents);
+    OptimizeVertexFetch(mesh);
+
+    report.vertexCountAfter = mesh.GetVertexCount();
+    report.after = AnalyzeVertexCache(mesh.indices, mesh.GetVertexCount());
+    return report;
+}
+
+void MeshOptimizer::DeduplicateVertices(MeshData& mesh)
+{
+    const unsigned int vertexCount = mesh.GetVertexCount();
+    const unsigned int stride = mesh.vertexStride;
+
+    std::unordered_map<std::string, unsigned int> uniqueVertices;
+    uniqueVertices.reserve(vertexCount);
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<unsigned char> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (unsigned int vertex = 0; vertex < vertexCount; vertex++)
+    {
+        const unsigned char* data = &mesh.vertices[vertex * stride];
+        const unsigned int newIndex = static_cast<unsigned int>(uniqueVertices.size());
+        const auto result = uniqueVertices.emplace(std::string(reinterpret_cast<const char*>(data), stride), newIndex);
+
+        if (result.second)
+        {
+            vertices.insert(vertices.end(), data, data + stride);
+        }
+
+        remap[vertex] = result.first->second;
+    }
+
+    for (unsigned int& index : mesh.indices)
+    {
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(vertices);
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount)
+{
+    const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // triangles using each vertex, as offsets into one flat array
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (unsigned int index : indices)
+    {
+        remainingTriangles[index]++;
+    }
+
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (unsigned int vertex = 0; vertex < vertexCount; vertex++)
+    {
+        adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangles[vertex];
+    }
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (unsigned int triangle = 0; triangle < triangleCount; triangle++)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const unsigned int vertex = indices[triangle * 3 + corner];
+            adjacency[fill[vertex]++] = triangle;
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int vertex = 0; vertex < vertexCount; vertex++)
+    {
+        vertexScores[vertex] = GetVertexScore(-1, remainingTriangles[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (unsigned int triangle = 0; triangle < triangleCount; triangle++)
+    {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    // cache holds up to ForsythCacheSize + 3 entries while a triangle is being added
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> nextCache;
+    cache.reserve(ForsythCacheSize + 3);
+    nextCache.reserve(ForsythCacheSize + 3);
+
+    unsigned int bestTriangle = InvalidIndex;
+    unsigned int scanCursor = 0;
+
+    for (unsigned int emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle == InvalidIndex)
+        {
+            // nothing in the cache is connected to what is left, start over from the best remaining triangle
+            float bestScore = -1.0f;
+            for (unsigned int triangle = scanCursor; triangle < triangleCount; triangle++)
+            {
+                if (!emitted[triangle] && triangleScores[triangle] > bestScore)
+                {
+                    bestScore = triangleScores[triangle];
+                    bestTriangle = triangle;
+                }
+            }
+
+            while (scanCursor < triangleCount && emitted[scanCursor])
+            {
+                scanCursor++;
+            }
+        }
+
+        const unsigned int* corners = &indices[bestTriangle * 3];
+        result.insert(result.end(), corners, corners + 3);
+        emitted[bestTriangle] = true;
+
+        // the triangle's vertices move to the front of the LRU cache
+        nextCache.assign(corners, corners + 3);
+        for (unsigned int vertex : cache)
+        {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const unsigned int vertex = corners[corner];
+            unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+            unsigned int* end = begin + remainingTriangles[vertex];
+            std::remove(begin, end, bestTriangle);
+            remainingTriangles[vertex]--;
+        }
+
+        for (size_t i = 0; i < nextCache.size(); i++)
+        {
+            const unsigned int vertex = nextCache[i];
+            const int position = i < ForsythCacheSize ? static_cast<int>(i) : -1;
+            vertexScores[vertex] = GetVertexScore(position, remainingTriangles[vertex]);
+        }
+
+        if (nextCache.size() > ForsythCacheSize)
+        {
+            nextCache.resize(ForsythCacheSize);
+        }
+
+        cache.swap(nextCache);
+
+        // only triangles around cached vertices changed score, the next best one is among them
+        bestTriangle = InvalidIndex;
+        float bestScore = -1.0f;
+        for (unsigned int vertex : cache)
+        {
+            const unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int i = 0; i < remainingTriangles[vertex]; i++)
+            {
+                const unsigned int triangle = begin[i];
+                const float score = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+                triangleScores[triangle] = score;
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(MeshData& mesh, unsigned int positionOffset, unsigned int positionComponents, float threshold)
+{
+    const unsigned int vertexCount = mesh.GetVertexCount();
+    const unsigned int triangleCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // hard boundaries: triangles where the cache starts over (all three vertices miss)
+    std::vector<unsigned int> clusters;
+    {
+        std::vector<unsigned int> timestamps(vertexCount, 0);
+        unsigned int time = 16 + 1;
+        for (unsigned int triangle = 0; triangle < triangleCount; triangle++)
+        {
+            if (SimulateTriangle(timestamps, time, 16, &mesh.indices[triangle * 3]) == 3)
+            {
+                clusters.push_back(triangle);
+            }
+        }
+
+        if (clusters.empty() || clusters[0] != 0)
+        {
+            clusters.insert(clusters.begin(), 0);
+        }
+    }
+
+    // soft boundaries: split a hard cluster wherever its running ACMR is already within threshold of the whole cluster's
+    std::vector<unsigned int> softClusters;
+    for (size_t cluster = 0; cluster < clusters.size(); cluster++)
+    {
+        const unsigned int begin = clusters[cluster];
+        const unsigned int end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangleCount;
+
+        std::vector<unsigned int> timestamps(vertexCount, 0);
+        unsigned int time = 16 + 1;
+        unsigned int misses = 0;
+        for (unsigned int triangle = begin; triangle < end; triangle++)
+        {
+            misses += SimulateTriangle(timestamps, time, 16, &mesh.indices[triangle * 3]);
+        }
+
+        const float clusterAcmr = static_cast<float>(misses) / (end - begin);
+
+        softClusters.push_back(begin);
+        std::fill(timestamps.begin(), timestamps.end(), 0);
+        time = 16 + 1;
+        unsigned int runningMisses = 0;
+        unsigned int runningStart = begin;
+        for (unsigned int triangle = begin; triangle < end; triangle++)
+        {
+            runningMisses += SimulateTriangle(timestamps, time, 16, &mesh.indices[triangle * 3]);
+            const unsigned int runningCount = triangle + 1 - runningStart;
+
+            if (triangle + 1 < end && static_cast<float>(runningMisses) / runningCount <= clusterAcmr * threshold)
+            {
+                softClusters.push_back(triangle + 1);
+                runningStart = triangle + 1;
+                runningMisses = 0;
+                std::fill(timestamps.begin(), timestamps.end(), 0);
+                time = 16 + 1;
+            }
+        }
+    }
+
+    // sort key: how far the cluster faces away from the mesh center, outward facing clusters occlude the rest
+    glm::vec3 meshCenter(0.0f);
+    for (unsigned int vertex = 0; vertex < vertexCount; vertex++)
+    {
+        meshCenter += GetPosition(mesh, vertex, positionOffset, positionComponents);
+    }
+    meshCenter /= static_cast<float>(vertexCount > 0 ? vertexCount : 1);
+
+    struct ClusterKey
+    {
+        float key;
+        unsigned int cluster;
+    };
+
+    std::vector<ClusterKey> keys(softClusters.size());
+    for (size_t cluster = 0; cluster < softClusters.size(); cluster++)
+    {
+        const unsigned int begin = softClusters[cluster];
+        const unsigned int end = cluster + 1 < softClusters.size() ? softClusters[cluster + 1] : triangleCount;
+
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (unsigned int triangle = begin; triangle < end; triangle++)
+        {
+            const glm::vec3 a = GetPosition(mesh, mesh.indices[triangle * 3], positionOffset, positionComponents);
+            const glm::vec3 b = GetPosition(mesh, mesh.indices[triangle * 3 + 1], positionOffset, positionComponents);
+            const glm::vec3 c = GetPosition(mesh, mesh.indices[triangle * 3 + 2], positionOffset, positionComponents);
+
+            // the cross product's length is twice the area, summing it weights both by area
+            const glm::vec3 weightedNormal = glm::cross(b - a, c - a);
+            const float triangleArea = glm::length(weightedNormal);
+            center += (a + b + c) * (triangleArea / 3.0f);
+            normal += weightedNormal;
+            area += triangleArea;
+        }
+
+        center = area > 0.0f ? center / area : center;
+        const float normalLength = glm::length(normal);
+        normal = normalLength > 0.0f ? normal / normalLength : normal;
+
+        keys[cluster] = { glm::dot(center - meshCenter, normal), static_cast<unsigned int>(cluster) };
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), [](const ClusterKey& a, const ClusterKey& b) { return a.key > b.key; });
+
+    std::vector<unsigned int> result;
+    result.reserve(mesh.indices.size());
+    for (const ClusterKey& key : keys)
+    {
+        const unsigned int begin = softClusters[key.cluster];
+        const unsigned int end = key.cluster + 1 < softClusters.size() ? softClusters[key.cluster + 1] : triangleCount;
+        result.insert(result.end(), mesh.indices.begin() + begin * 3, mesh.indices.begin() + end * 3);
+    }
+
+    mesh.indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(MeshData& mesh)
+{
+    const unsigned int stride = mesh.vertexStride;
+    std::vector<unsigned int> remap(mesh.GetVertexCount(), InvalidIndex);
+    std::vector<unsigned char> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    unsigned int nextVertex = 0;
+    for (unsigned int& index : mesh.indices)
+    {
+        if (remap[index] == InvalidIndex)
+        {
+            remap[index] = nextVertex++;
+            vertices.insert(vertices.end(), mesh.vertices.begin() + index * stride, mesh.vertices.begin() + (index + 1) * stride);
+        }
+
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(vertices);
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+    const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+        return { 0.0f, 0.0f };
+    }
+
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+    for (unsigned int triangle = 0; triangle < triangleCount; triangle++)
+    {
+        misses += SimulateTriangle(timestamps, time, cacheSize, &indices[triangle * 3]);
+    }
+
+    return { static_cast<float>(misses) / triangleCount, static_cast<float>(misses) / vertexCount };
+}
+
+std::unique_ptr<IndexBuffer> MeshOptimizer::CreateIndexBuffer(const MeshData& mesh, BufferUsage usage)
+{
+    const unsigned int count = static_cast<unsigned int>(mesh.indices.size());
+
+    if (mesh.GetVertexCount() <= 0x10000)
+    {
+        std::vector<unsigned short> shortIndices(mesh.indices.begin(), mesh.indices.end());
+        return std::unique_ptr<IndexBuffer>(new IndexBuffer(shortIndices.data(), count, usage));
+    }
+
+    return std::unique_ptr<IndexBuffer>(new IndexBuffer(mesh.indices.data(), count, usage));
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BufferObject.h"
+#include "IndexBuffer.h"
+
+// Interleaved vertices of any layout plus a triangle list indexing them
+struct MeshData
+{
+    std::vector<unsigned char> vertices;
+    unsigned int vertexStride;
+    std::vector<unsigned int> indices;
+
+    unsigned int GetVertexCount() const { return vertexStride == 0 ? 0 : static_cast<unsigned int>(vertices.size() / vertexStride); }
+};
+
+struct VertexCacheStats
+{
+    // average cache miss ratio, vertex shader runs per triangle (0.5 is ideal for large grids, 3 is the worst)
+    float acmr;
+    // average transform to vertex ratio, vertex shader runs per unique vertex (1 is ideal)
+    float atvr;
+};
+
+struct MeshOptimizationReport
+{
+    unsigned int vertexCountBefore;
+    unsigned int vertexCountAfter;
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Load time processing that reduces vertex shader invocations, overdraw and index/vertex bandwidth.
+// Every step keeps the triangles and their winding, only their order and the vertex numbering change.
+class MeshOptimizer
+{
+public:
+    // Runs every step below in the recommended order. Positions are positionComponents (2 or 3) floats
+    // at positionOffset bytes inside each vertex.
+    static MeshOptimizationReport Optimize(MeshData& mesh, unsigned int positionOffset = 0, unsigned int positionComponents = 3);
+
+    // Merges bit identical vertices
+    static void DeduplicateVertices(MeshData& mesh);
+    // Reorders triangles for the post transform cache (Tom Forsyth's linear speed vertex cache optimisation)
+    static void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+    // Reorders clusters of the cache optimised triangles so outward facing ones come first, losing at most
+    // threshold times the ACMR (Sander, Nehab, Barczak: fast triangle reordering for vertex locality and reduced overdraw)
+    static void OptimizeOverdraw(MeshData& mesh, unsigned int positionOffset, unsigned int positionComponents, float threshold = 1.05f);
+    // Renumbers vertices in the order the indices first use them, dropping unreferenced ones
+    static void OptimizeVertexFetch(MeshData& mesh);
+
+    // Simulates a FIFO post transform cache of cacheSize entries
+    static VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+    // Picks 16 bit indices when the vertex count allows it
+    static std::unique_ptr<IndexBuffer> CreateIndexBuffer(const MeshData& mesh, BufferUsage usage = BufferUsage::Static);
+};
@@ -0,0 +1,72 @@
+﻿#include "MeshPool.h"
+
+#include "Renderer.h"
+
+MeshPool::Page::Page(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+    : vertexBuffer(vertexCapacity * layout.GetStride(), BufferUsage::Dynamic),
+      indexBuffer(static_cast<const unsigned int*>(nullptr), indexCapacity, BufferUsage::Dynamic),
+      vertexAllocator(vertexCapacity), indexAllocator(indexCapacity)
+{
+    vertexArray.AddBuffer(vertexBuffer, layout);
+    vertexArray.SetIndexBuffer(indexBuffer);
+    vertexArray.Unbind();
+}
+
+MeshPool::MeshPool(const VertexBufferLayout& layout, unsigned int verticesPerPage, unsigned int indicesPerPage)
+    : layout(layout), verticesPerPage(verticesPerPage), indicesPerPage(indicesPerPage)
+{
+}
+
+MeshHandle MeshPool::Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    // the allocators hand out no space for empty ranges, an empty mesh would never fit any page
+    ASSERT(vertexCount > 0 && indexCount > 0)
+    ASSERT(vertexCount <= verticesPerPage && indexCount <= indicesPerPage)
+
+    MeshHandle mesh {};
+    for (unsigned int page = 0; page < pages.size(); page++)
+    {
+        if (TryAllocate(page, vertices, vertexCount, indices, indexCount, mesh))
+        {
+            return mesh;
+        }
+    }
+
+    // every page is full, a fresh one always has room for a mesh within the page limits
+    pages.emplace_back(new Page(layout, verticesPerPage, indicesPerPage));
+    const bool allocated = TryAllocate(static_cast<unsigned int>(pages.size() - 1), vertices, vertexCount, indices, indexCount, mesh);
+    ASSERT(allocated)
+
+    return mesh;
+}
+
+void MeshPool::Free(const MeshHandle& mesh)
+{
+    Page& page = *pages[mesh.page];
+    page.vertexAllocator.Free(static_cast<unsigned int>(mesh.baseVertex), mesh.vertexCount);
+    page.indexAllocator.Free(mesh.firstIndex, mesh.indexCount);
+}
+
+bool MeshPool::TryAllocate(unsigned int page, const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, MeshHandle& mesh)
+{
+    Page& candidate = *pages[page];
+    const unsigned int baseVertex = candidate.vertexAllocator.Allocate(vertexCount);
+    if (baseVertex == OffsetAllocator::InvalidOffset)
+    {
+        return false;
+    }
+
+    const unsigned int firstIndex = candidate.indexAllocator.Allocate(indexCount);
+    if (firstIndex == OffsetAllocator::InvalidOffset)
+    {
+        candidate.vertexAllocator.Free(baseVertex, vertexCount);
+        return false;
+    }
+
+    const unsigned int stride = layout.GetStride();
+    candidate.vertexBuffer.Update(baseVertex * stride, vertices, vertexCount * stride);
+    candidate.indexBuffer.Update(firstIndex * sizeof(unsigned int), indices, indexCount * sizeof(unsigned int));
+
+    mesh = { page, static_cast<int>(baseVertex), vertexCount, firstIndex, indexCount };
+    return true;
+}
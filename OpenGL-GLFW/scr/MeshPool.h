@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "IndexBuffer.h"
+#include "OffsetAllocator.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// Where a mesh lives inside a MeshPool. Indices are stored relative to the mesh, so drawing adds baseVertex.
+struct MeshHandle
+{
+    unsigned int page;
+    int baseVertex;
+    unsigned int vertexCount;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+};
+
+// Carves meshes sharing one vertex layout out of a few large vertex/index buffer pages instead of
+// one buffer pair per mesh. Meshes in the same page share a vertex array, so they draw without
+// rebinding and can be submitted together through an IndirectCommandBuffer.
+class MeshPool
+{
+public:
+    MeshPool(const VertexBufferLayout& layout, unsigned int verticesPerPage = 1 << 18, unsigned int indicesPerPage = 1 << 20);
+    ~MeshPool() = default;
+
+    // indices are relative to the first vertex of this mesh
+    MeshHandle Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+    void Free(const MeshHandle& mesh);
+
+    const VertexArray& GetVertexArray(unsigned int page) const { return pages[page]->vertexArray; }
+    const IndexBuffer& GetIndexBuffer(unsigned int page) const { return pages[page]->indexBuffer; }
+    unsigned int GetPageCount() const { return static_cast<unsigned int>(pages.size()); }
+
+private:
+    struct Page
+    {
+        Page(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+
+        VertexBuffer vertexBuffer;
+        IndexBuffer indexBuffer;
+        VertexArray vertexArray;
+        OffsetAllocator vertexAllocator;
+        OffsetAllocator indexAllocator;
+    };
+
+    bool TryAllocate(unsigned int page, const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount, MeshHandle& mesh);
+
+    VertexBufferLayout layout;
+    unsigned int verticesPerPage;
+    unsigned int indicesPerPage;
+    // pages never move, the vertex arrays inside are referenced by draws
+    std::vector<std::unique_ptr<Page>> pages;
+};
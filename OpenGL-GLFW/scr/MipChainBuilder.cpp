@@ -0,0 +1,252 @@
+﻿#include "MipChainBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ThreadPool.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MIP_CHAIN_USE_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // below this many rows splitting a level costs more than it saves
+    constexpr int MinRowsPerJob = 32;
+
+    float SrgbToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    struct SrgbTables
+    {
+        float toLinear[256];
+        // linear value halfway between two consecutive 8 bit codes, encoding is a search in here
+        float encodeThresholds[255];
+
+        SrgbTables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                toLinear[i] = SrgbToLinear(static_cast<float>(i) / 255.0f);
+            }
+
+            for (int i = 0; i < 255; i++)
+            {
+                encodeThresholds[i] = SrgbToLinear((static_cast<float>(i) + 0.5f) / 255.0f);
+            }
+        }
+    };
+
+    const SrgbTables& GetSrgbTables()
+    {
+        static const SrgbTables tables;
+        return tables;
+    }
+
+    unsigned char LinearToSrgb(const SrgbTables& tables, float value)
+    {
+        const float* end = tables.encodeThresholds + 255;
+        return static_cast<unsigned char>(std::upper_bound(tables.encodeThresholds, end, value) - tables.encodeThresholds);
+    }
+
+    // Source texels behind one destination texel along an axis. Even sizes average pairs, odd sizes
+    // take three taps with polyphase box weights so the texel a 2x2 box would drop still contributes.
+    struct Footprint
+    {
+        int count;
+        int index[3];
+        float weight[3];
+    };
+
+    Footprint GetFootprint(int position, int sourceSize)
+    {
+        if (sourceSize == 1)
+        {
+            return { 1, { 0, 0, 0 }, { 1.0f, 0.0f, 0.0f } };
+        }
+
+        if (sourceSize % 2 == 0)
+        {
+            return { 2, { position * 2, position * 2 + 1, 0 }, { 0.5f, 0.5f, 0.0f } };
+        }
+
+        // sourceSize = 2 * half + 1 texels shared by half outputs, each covering sourceSize / half of them
+        const int half = sourceSize / 2;
+        const float scale = 1.0f / static_cast<float>(sourceSize);
+        return { 3, { position * 2, position * 2 + 1, position * 2 + 2 },
+            { static_cast<float>(half - position) * scale, static_cast<float>(half) * scale, static_cast<float>(position + 1) * scale } };
+    }
+}
+
+std::vector<MipLevel> MipChainBuilder::Build(const unsigned char* pixels, int width, int height, ThreadPool* pool)
+{
+    std::vector<MipLevel> levels(GetLevelCount(width, height));
+    levels[0] = { width, height, std::vector<unsigned char>(pixels, pixels + static_cast<size_t>(width) * height * 4) };
+
+    if (levels.size() == 1)
+    {
+        return levels;
+    }
+
+    std::vector<float> linear(static_cast<size_t>(width) * height * 4);
+    ForEachRowRange(pool, height, [&](int firstRow, int lastRow)
+    {
+        LoadRows(pixels, width, firstRow, lastRow, linear.data());
+    });
+
+    // every level is filtered from the previous linear level, so nothing is decoded twice
+    std::vector<float> next;
+    int sourceWidth = width;
+    int sourceHeight = height;
+
+    for (size_t level = 1; level < levels.size(); level++)
+    {
+        const int levelWidth = std::max(1, sourceWidth / 2);
+        const int levelHeight = std::max(1, sourceHeight / 2);
+
+        MipLevel& mip = levels[level];
+        mip.width = levelWidth;
+        mip.height = levelHeight;
+        mip.pixels.resize(static_cast<size_t>(levelWidth) * levelHeight * 4);
+        next.resize(static_cast<size_t>(levelWidth) * levelHeight * 4);
+
+        ForEachRowRange(pool, levelHeight, [&](int firstRow, int lastRow)
+        {
+            DownsampleRows(linear.data(), sourceWidth, sourceHeight, levelWidth, firstRow, lastRow, next.data());
+            StoreRows(next.data(), levelWidth, firstRow, lastRow, mip.pixels.data());
+        });
+
+        linear.swap(next);
+        sourceWidth = levelWidth;
+        sourceHeight = levelHeight;
+    }
+
+    return levels;
+}
+
+unsigned int MipChainBuilder::GetLevelCount(int width, int height)
+{
+    unsigned int levels = 1;
+    int size = std::max(width, height);
+    while (size > 1)
+    {
+        size /= 2;
+        levels++;
+    }
+
+    return levels;
+}
+
+void MipChainBuilder::LoadRows(const unsigned char* pixels, int width, int firstRow, int lastRow, float* linear)
+{
+    const SrgbTables& tables = GetSrgbTables();
+
+    for (size_t i = static_cast<size_t>(firstRow) * width; i < static_cast<size_t>(lastRow) * width; i++)
+    {
+        const unsigned char* texel = &pixels[i * 4];
+        const float alpha = static_cast<float>(texel[3]) / 255.0f;
+
+        linear[i * 4 + 0] = tables.toLinear[texel[0]] * alpha;
+        linear[i * 4 + 1] = tables.toLinear[texel[1]] * alpha;
+        linear[i * 4 + 2] = tables.toLinear[texel[2]] * alpha;
+        linear[i * 4 + 3] = alpha;
+    }
+}
+
+void MipChainBuilder::DownsampleRows(const float* source, int sourceWidth, int sourceHeight, int width, int firstRow, int lastRow, float* destination)
+{
+    std::vector<Footprint> columns(width);
+    for (int x = 0; x < width; x++)
+    {
+        columns[x] = GetFootprint(x, sourceWidth);
+    }
+
+    for (int y = firstRow; y < lastRow; y++)
+    {
+        const Footprint rows = GetFootprint(y, sourceHeight);
+        float* output = destination + static_cast<size_t>(y) * width * 4;
+
+        for (int x = 0; x < width; x++)
+        {
+            const Footprint& column = columns[x];
+
+#if defined(MIP_CHAIN_USE_SSE)
+            __m128 sum = _mm_setzero_ps();
+            for (int row = 0; row < rows.count; row++)
+            {
+                const float* input = source + static_cast<size_t>(rows.index[row]) * sourceWidth * 4;
+
+                __m128 horizontal = _mm_setzero_ps();
+                for (int tap = 0; tap < column.count; tap++)
+                {
+                    horizontal = _mm_add_ps(horizontal, _mm_mul_ps(_mm_loadu_ps(input + column.index[tap] * 4), _mm_set1_ps(column.weight[tap])));
+                }
+
+                sum = _mm_add_ps(sum, _mm_mul_ps(horizontal, _mm_set1_ps(rows.weight[row])));
+            }
+            _mm_storeu_ps(output + x * 4, sum);
+#else
+            for (int channel = 0; channel < 4; channel++)
+            {
+                float sum = 0.0f;
+                for (int row = 0; row < rows.count; row++)
+                {
+                    const float* input = source + static_cast<size_t>(rows.index[row]) * sourceWidth * 4;
+
+                    float horizontal = 0.0f;
+                    for (int tap = 0; tap < column.count; tap++)
+                    {
+                        horizontal += input[column.index[tap] * 4 + channel] * column.weight[tap];
+                    }
+
+                    sum += horizontal * rows.weight[row];
+                }
+                output[x * 4 + channel] = sum;
+            }
+#endif
+        }
+    }
+}
+
+void MipChainBuilder::StoreRows(const float* linear, int width, int firstRow, int lastRow, unsigned char* pixels)
+{
+    const SrgbTables& tables = GetSrgbTables();
+
+    for (size_t i = static_cast<size_t>(firstRow) * width; i < static_cast<size_t>(lastRow) * width; i++)
+    {
+        const float* texel = &linear[i * 4];
+        const float alpha = texel[3];
+        unsigned char* output = &pixels[i * 4];
+
+        // undo the premultiplication, a fully transparent texel keeps black
+        const float inverseAlpha = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            output[channel] = LinearToSrgb(tables, texel[channel] * inverseAlpha);
+        }
+        output[3] = static_cast<unsigned char>(std::min(alpha, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+void MipChainBuilder::ForEachRowRange(ThreadPool* pool, int rows, const std::function<void(int firstRow, int lastRow)>& job)
+{
+    if (!pool || rows < MinRowsPerJob * 2)
+    {
+        job(0, rows);
+        return;
+    }
+
+    const int jobCount = std::min(static_cast<int>(pool->GetThreadCount()), rows / MinRowsPerJob);
+    const int rowsPerJob = (rows + jobCount - 1) / jobCount;
+
+    for (int firstRow = 0; firstRow < rows; firstRow += rowsPerJob)
+    {
+        const int lastRow = std::min(firstRow + rowsPerJob, rows);
+        pool->Enqueue([&job, firstRow, lastRow] { job(firstRow, lastRow); });
+    }
+
+    pool->Wait();
+}
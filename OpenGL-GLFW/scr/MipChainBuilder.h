@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <functional>
+#include <vector>
+
+class ThreadPool;
+
+struct MipLevel
+{
+    int width;
+    int height;
+    // RGBA8, sRGB encoded color with straight alpha like the source
+    std::vector<unsigned char> pixels;
+};
+
+// Builds a full mip chain on the CPU, e.g. on a loader thread so the result can be cached with the image.
+// Texels are averaged in linear space and weighted by alpha, so minified sprites neither darken nor grow
+// dark fringes around transparent edges, which glGenerateMipmap on an RGBA8 texture does not guarantee.
+class MipChainBuilder
+{
+public:
+    // Every level down to 1x1, levels[0] is a copy of the source. With a pool the rows of each level
+    // are split across its workers, the pool must not be running jobs of its own at the same time.
+    static std::vector<MipLevel> Build(const unsigned char* pixels, int width, int height, ThreadPool* pool = nullptr);
+    static unsigned int GetLevelCount(int width, int height);
+
+private:
+    // linear images are premultiplied RGBA floats, one __m128 per texel
+    static void LoadRows(const unsigned char* pixels, int width, int firstRow, int lastRow, float* linear);
+    static void DownsampleRows(const float* source, int sourceWidth, int sourceHeight, int width, int firstRow, int lastRow, float* destination);
+    static void StoreRows(const float* linear, int width, int firstRow, int lastRow, unsigned char* pixels);
+
+    static void ForEachRowRange(ThreadPool* pool, int rows, const std::function<void(int firstRow, int lastRow)>& job);
+};
@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Unbounded multiple producer, single consumer queue without locks. Push may be called from any
+// thread, TryPop only from the one consuming thread. A push that is still in progress can make
+// TryPop report empty for a moment, the item shows up on the next call.
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : head(&stub), tail(&stub)
+    {
+    }
+
+    ~MpscQueue()
+    {
+        T value;
+        while (TryPop(value))
+        {
+        }
+
+        if (tail != &stub)
+        {
+            delete tail;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T value)
+    {
+        Node* node = new Node();
+        node->value = std::move(value);
+
+        // claim the head first, then link the previous one to us, the consumer waits for the link
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    bool TryPop(T& value)
+    {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            return false;
+        }
+
+        // next becomes the new sentinel, its value has been taken
+        value = std::move(next->value);
+        if (tail != &stub)
+        {
+            delete tail;
+        }
+        tail = next;
+
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next { nullptr };
+        T value;
+    };
+
+    Node stub;
+    std::atomic<Node*> head;
+    // only touched by the consumer
+    Node* tail;
+};
@@ -0,0 +1,108 @@
+﻿#include "OffsetAllocator.h"
+
+#include <iterator>
+
+#include "Renderer.h"
+
+OffsetAllocator::OffsetAllocator(unsigned int size)
+    : size(size), freeSpace(0)
+{
+    Reset();
+}
+
+unsigned int OffsetAllocator::Allocate(unsigned int size)
+{
+    if (size == 0)
+    {
+        return InvalidOffset;
+    }
+
+    const auto bestFit = freeBySize.lower_bound(size);
+    if (bestFit == freeBySize.end())
+    {
+        return InvalidOffset;
+    }
+
+    const unsigned int offset = bestFit->second;
+    const unsigned int rangeSize = bestFit->first;
+    EraseFreeRange(freeByOffset.find(offset));
+
+    // the remainder stays free right after the allocation
+    if (rangeSize > size)
+    {
+        InsertFreeRange(offset + size, rangeSize - size);
+    }
+
+    freeSpace -= size;
+    return offset;
+}
+
+void OffsetAllocator::Free(unsigned int offset, unsigned int size)
+{
+    ASSERT(offset + size <= this->size)
+
+    freeSpace += size;
+
+    const auto next = freeByOffset.lower_bound(offset);
+    ASSERT(next == freeByOffset.end() || next->first >= offset + size)
+
+    if (next != freeByOffset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        EraseFreeRange(next);
+    }
+
+    const auto following = freeByOffset.lower_bound(offset);
+    if (following != freeByOffset.begin())
+    {
+        const auto previous = std::prev(following);
+        ASSERT(previous->first + previous->second <= offset)
+
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            EraseFreeRange(previous);
+        }
+    }
+
+    InsertFreeRange(offset, size);
+}
+
+void OffsetAllocator::Reset()
+{
+    freeByOffset.clear();
+    freeBySize.clear();
+    freeSpace = size;
+
+    if (size > 0)
+    {
+        InsertFreeRange(0, size);
+    }
+}
+
+unsigned int OffsetAllocator::GetLargestFreeRange() const
+{
+    return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+void OffsetAllocator::InsertFreeRange(unsigned int offset, unsigned int size)
+{
+    freeByOffset[offset] = size;
+    freeBySize.insert({ size, offset });
+}
+
+void OffsetAllocator::EraseFreeRange(std::map<unsigned int, unsigned int>::iterator range)
+{
+    auto candidates = freeBySize.equal_range(range->second);
+    for (auto it = candidates.first; it != candidates.second; ++it)
+    {
+        if (it->second == range->first)
+        {
+            freeBySize.erase(it);
+            break;
+        }
+    }
+
+    freeByOffset.erase(range);
+}
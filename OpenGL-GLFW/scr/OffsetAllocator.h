@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <map>
+
+// Hands out ranges of a fixed size address space (in any unit, e.g. vertices or indices) using best fit.
+// Freed ranges merge with their free neighbours, so the space does not fragment into unusable slivers.
+class OffsetAllocator
+{
+public:
+    static constexpr unsigned int InvalidOffset = 0xFFFFFFFF;
+
+    OffsetAllocator(unsigned int size);
+    ~OffsetAllocator() = default;
+
+    // Returns InvalidOffset when no free range is large enough
+    unsigned int Allocate(unsigned int size);
+    void Free(unsigned int offset, unsigned int size);
+    void Reset();
+
+    unsigned int GetSize() const { return size; }
+    unsigned int GetFreeSpace() const { return freeSpace; }
+    unsigned int GetLargestFreeRange() const;
+
+private:
+    void InsertFreeRange(unsigned int offset, unsigned int size);
+    void EraseFreeRange(std::map<unsigned int, unsigned int>::iterator range);
+
+    unsigned int size;
+    unsigned int freeSpace;
+    // offset -> size, to find the neighbours of a freed range
+    std::map<unsigned int, unsigned int> freeByOffset;
+    // size -> offset, to find the best fit
+    std::multimap<unsigned int, unsigned int> freeBySize;
+};
@@ -0,0 +1,174 @@
+﻿#include "RenderQueue.h"
+
+#include "Renderer.h"
+
+void RenderQueue::Submit(const DrawPacket& packet, RenderPass pass, bool translucent, float depth)
+{
+    commands.push_back({ MakeKey(packet, pass, translucent, depth), static_cast<unsigned int>(packets.size()) });
+    packets.push_back(packet);
+}
+
+void RenderQueue::Submit(const CommandList& commandList)
+{
+    const unsigned int packetOffset = static_cast<unsigned int>(packets.size());
+
+    for (const RenderCommand& command : commandList.GetCommands())
+    {
+        commands.push_back({ command.key, command.packetIndex + packetOffset });
+    }
+
+    packets.insert(packets.end(), commandList.GetPackets().begin(), commandList.GetPackets().end());
+}
+
+void RenderQueue::RecordParallel(ThreadPool& pool, unsigned int partitionCount, const std::function<void(unsigned int partition, CommandList& commandList)>& record)
+{
+    if (partitionLists.size() < partitionCount)
+    {
+        partitionLists.resize(partitionCount);
+    }
+
+    for (unsigned int partition = 0; partition < partitionCount; partition++)
+    {
+        CommandList& commandList = partitionLists[partition];
+        commandList.Clear();
+
+        pool.Enqueue([&record, &commandList, partition] { record(partition, commandList); });
+    }
+
+    pool.Wait();
+
+    for (unsigned int partition = 0; partition < partitionCount; partition++)
+    {
+        Submit(partitionLists[partition]);
+    }
+}
+
+void RenderQueue::Sort()
+{
+    const size_t count = commands.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    sortBuffer.resize(count);
+
+    // LSD radix sort, one byte per pass
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const RenderCommand& command : commands)
+        {
+            histogram[(command.key >> shift) & 0xFF]++;
+        }
+
+        // every key shares this byte, nothing would move
+        if (histogram[(commands[0].key >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            const size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const RenderCommand& command : commands)
+        {
+            sortBuffer[histogram[(command.key >> shift) & 0xFF]++] = command;
+        }
+
+        commands.swap(sortBuffer);
+    }
+}
+
+void RenderQueue::Execute()
+{
+    stats = RenderQueueStats();
+    stats.commands = static_cast<unsigned int>(commands.size());
+
+    const Shader* currentShader = nullptr;
+    const Texture* currentTexture = nullptr;
+    const VertexArray* currentVertexArray = nullptr;
+    const IndexBuffer* currentIndexBuffer = nullptr;
+
+    for (const RenderCommand& command : commands)
+    {
+        const DrawPacket& packet = packets[command.packetIndex];
+
+        if (packet.shader != currentShader)
+        {
+            packet.shader->Bind();
+            currentShader = packet.shader;
+            stats.shaderBinds++;
+        }
+
+        if (packet.texture && packet.texture != currentTexture)
+        {
+            packet.texture->Bind();
+            currentTexture = packet.texture;
+            stats.textureBinds++;
+        }
+
+        if (packet.vertexArray != currentVertexArray)
+        {
+            packet.vertexArray->Bind();
+            currentVertexArray = packet.vertexArray;
+            stats.vertexArrayBinds++;
+
+            // the element buffer binding is part of the vertex array state
+            currentIndexBuffer = nullptr;
+        }
+
+        if (packet.indexBuffer != currentIndexBuffer)
+        {
+            packet.indexBuffer->Bind();
+            currentIndexBuffer = packet.indexBuffer;
+        }
+
+        packet.shader->SetUniformMatrix4f("u_Model", packet.model);
+        GLCall(glDrawElements(GL_TRIANGLES, packet.indexBuffer->GetCount(), packet.indexBuffer->GetIndexType(), nullptr))
+    }
+}
+
+void RenderQueue::Clear()
+{
+    commands.clear();
+    packets.clear();
+}
+
+uint64_t RenderQueue::MakeKey(const DrawPacket& packet, RenderPass pass, bool translucent, float depth)
+{
+    const unsigned int textureId = packet.texture ? packet.texture->GetRendererId() : 0;
+    return MakeKey(pass, translucent, packet.shader->GetRendererId(), textureId, packet.vertexArray->GetRendererId(), depth);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, bool translucent, unsigned int shaderId, unsigned int textureId, unsigned int vertexArrayId, float depth)
+{
+    const float clampedDepth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    const uint64_t depthBits = static_cast<uint64_t>(clampedDepth * 0xFFFFFF);
+
+    // ids only steer the ordering, so wrapping them into their field is harmless
+    const uint64_t material = (static_cast<uint64_t>(shaderId & 0xFFF) << 23)
+                            | (static_cast<uint64_t>(textureId & 0xFFF) << 11)
+                            | static_cast<uint64_t>(vertexArrayId & 0x7FF);
+
+    uint64_t key = static_cast<uint64_t>(static_cast<unsigned char>(pass) & 0xF) << 60;
+
+    if (translucent)
+    {
+        key |= 1ull << 59;
+        key |= (0xFFFFFF - depthBits) << 35;
+        key |= material;
+    }
+    else
+    {
+        key |= material << 24;
+        key |= depthBits;
+    }
+
+    return key;
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "CommandList.h"
+#include "ThreadPool.h"
+
+struct RenderQueueStats
+{
+    unsigned int commands = 0;
+    unsigned int shaderBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+};
+
+class RenderQueue
+{
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    // depth is expected in [0, 1], 0 being closest to the camera
+    void Submit(const DrawPacket& packet, RenderPass pass, bool translucent, float depth);
+    void Submit(const CommandList& commandList);
+
+    // Runs record once per partition on the pool, each call filling its own CommandList,
+    // then merges the lists in partition order so the result does not depend on thread timing
+    void RecordParallel(ThreadPool& pool, unsigned int partitionCount, const std::function<void(unsigned int partition, CommandList& commandList)>& record);
+
+    void Sort();
+    void Execute();
+    void Clear();
+
+    const RenderQueueStats& GetStats() const { return stats; }
+
+    // Key layout, most significant bits first:
+    // opaque:      pass(4) | translucent(1) = 0 | shader(12) | texture(12) | vertexArray(11) | depth(24) front to back
+    // translucent: pass(4) | translucent(1) = 1 | depth(24) back to front | shader(12) | texture(12) | vertexArray(11)
+    static uint64_t MakeKey(RenderPass pass, bool translucent, unsigned int shaderId, unsigned int textureId, unsigned int vertexArrayId, float depth);
+    static uint64_t MakeKey(const DrawPacket& packet, RenderPass pass, bool translucent, float depth);
+
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<RenderCommand> sortBuffer;
+    std::vector<DrawPacket> packets;
+    std::vector<CommandList> partitionLists;
+    RenderQueueStats stats;
+};
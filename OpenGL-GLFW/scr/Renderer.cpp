@@ -1,4 +1,5 @@
 ﻿#include "Renderer.h"
+#include "MeshPool.h"
 #include <iostream>
 
 void GLClearError()
@@ -20,10 +21,84 @@ bool GLLogCall(const char* function, const char* file, int line)
 void Renderer::Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader) const
 {
     shader.Bind();
+    // the element buffer binding is part of the vertex array state, so the vertex array goes first
+    vertexArray.Bind();
+    indexBuffer.Bind();
+    
+    GLCall(glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), indexBuffer.GetIndexType(), nullptr))
+}
+
+void Renderer::Draw(const VertexArray& format, const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const Shader& shader) const
+{
+    shader.Bind();
+    format.BindVertexBuffer(vertexBuffer);
+    indexBuffer.Bind();
+
+    GLCall(glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), indexBuffer.GetIndexType(), nullptr))
+}
+
+void Renderer::Draw(const MeshPool& meshPool, const MeshHandle& mesh, const Shader& shader) const
+{
+    shader.Bind();
+    const IndexBuffer& indexBuffer = meshPool.GetIndexBuffer(mesh.page);
+    meshPool.GetVertexArray(mesh.page).Bind();
     indexBuffer.Bind();
+
+    void* firstIndex = reinterpret_cast<void*>(static_cast<size_t>(mesh.firstIndex) * indexBuffer.GetIndexSize());
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, indexBuffer.GetIndexType(), firstIndex, mesh.baseVertex))
+}
+
+void Renderer::DrawInstanced(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int instanceCount) const
+{
+    shader.Bind();
     vertexArray.Bind();
+    indexBuffer.Bind();
     
-    GLCall(glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), GL_UNSIGNED_INT, nullptr))
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, indexBuffer.GetCount(), indexBuffer.GetIndexType(), nullptr, instanceCount))
+}
+
+void Renderer::DrawFullscreen(const VertexArray& vertexArray, const Shader& shader) const
+{
+    shader.Bind();
+    vertexArray.Bind();
+
+    GLCall(glDrawArrays(GL_TRIANGLES, 0, 3))
+}
+
+void Renderer::DrawMultiIndirect(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, const IndirectCommandBuffer& commands) const
+{
+    shader.Bind();
+    vertexArray.Bind();
+    indexBuffer.Bind();
+
+    if (SupportsMultiDrawIndirect())
+    {
+        shader.SetUniform1i("u_DrawIdOffset", 0);
+        commands.Bind();
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, indexBuffer.GetIndexType(), nullptr, commands.GetCount(), 0))
+        return;
+    }
+
+    const auto& drawCommands = commands.GetCommands();
+    for (unsigned int i = 0; i < drawCommands.size(); i++)
+    {
+        const DrawElementsIndirectCommand& command = drawCommands[i];
+        void* firstIndex = reinterpret_cast<void*>(static_cast<size_t>(command.firstIndex) * indexBuffer.GetIndexSize());
+
+        shader.SetUniform1i("u_DrawIdOffset", static_cast<int>(i));
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.count, indexBuffer.GetIndexType(), firstIndex, command.baseVertex))
+    }
+}
+
+bool Renderer::SupportsMultiDrawIndirect()
+{
+    // gl_DrawIDARB is how the shader tells the draws apart, so both are required
+    return GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_draw_parameters;
+}
+
+bool Renderer::SupportsDirectStateAccess()
+{
+    return GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
 }
 
 void Renderer::Clear() const
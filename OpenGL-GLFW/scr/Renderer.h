@@ -3,6 +3,7 @@
 #include <GL/glew.h>
 
 #include "IndexBuffer.h"
+#include "IndirectCommandBuffer.h"
 #include "Shader.h"
 #include "VertexArray.h"
 
@@ -11,6 +12,9 @@
 x;\
 ASSERT(GLLogCall(#x, __FILE__, __LINE__))
 
+class MeshPool;
+struct MeshHandle;
+
 void GLClearError();
 
 bool GLLogCall(const char* function, const char* file, int line);
@@ -19,6 +23,20 @@ class Renderer
 {
 public:
     void Draw(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader) const;
+    // Binds the mesh's page, consecutive draws from the same page skip the binds through the state cache
+    void Draw(const MeshPool& meshPool, const MeshHandle& mesh, const Shader& shader) const;
+    // Draws vertexBuffer through a format only vertex array (see VertexArray::SetFormat)
+    void Draw(const VertexArray& format, const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const Shader& shader) const;
+    void DrawInstanced(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, const Shader& shader, unsigned int instanceCount) const;
+    // Submits every command in one glMultiDrawElementsIndirect when available, otherwise loops glDrawElementsBaseVertex.
+    // The shader gets the draw id from gl_DrawIDARB + u_DrawIdOffset.
+    void DrawMultiIndirect(const VertexArray& vertexArray, const IndexBuffer& indexBuffer, Shader& shader, const IndirectCommandBuffer& commands) const;
+    // One triangle covering the viewport, the shader derives it from gl_VertexID. Core profile
+    // still wants a vertex array bound, an empty one does.
+    void DrawFullscreen(const VertexArray& vertexArray, const Shader& shader) const;
+    static bool SupportsMultiDrawIndirect();
+    // GL 4.5 / ARB_direct_state_access, the wrappers then create and edit objects without binding them
+    static bool SupportsDirectStateAccess();
     void Clear() const;
     
 private:
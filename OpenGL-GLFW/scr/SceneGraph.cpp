@@ -0,0 +1,109 @@
+﻿#include "SceneGraph.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+
+SceneNode SceneGraph::CreateNode(SceneNode parent)
+{
+    ASSERT(parent == InvalidSceneNode || parent < GetNodeCount())
+
+    const SceneNode node = GetNodeCount();
+    parents.push_back(parent);
+    translations.emplace_back(0.0f);
+    rotations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+    scales.emplace_back(1.0f);
+    worldMatrices.emplace_back(1.0f);
+    localDirty.push_back(1);
+    worldChanged.push_back(0);
+    anyDirty = true;
+
+    return node;
+}
+
+void SceneGraph::SetTranslation(SceneNode node, const glm::vec3& translation)
+{
+    if (translations[node] != translation)
+    {
+        translations[node] = translation;
+        MarkDirty(node);
+    }
+}
+
+void SceneGraph::SetRotation(SceneNode node, const glm::quat& rotation)
+{
+    if (rotations[node] != rotation)
+    {
+        rotations[node] = rotation;
+        MarkDirty(node);
+    }
+}
+
+void SceneGraph::SetScale(SceneNode node, const glm::vec3& scale)
+{
+    if (scales[node] != scale)
+    {
+        scales[node] = scale;
+        MarkDirty(node);
+    }
+}
+
+unsigned int SceneGraph::UpdateTransforms()
+{
+    const unsigned int nodeCount = GetNodeCount();
+
+    // nothing moved since the last update, static scenes stop here
+    if (!anyDirty)
+    {
+        if (!worldChanged.empty())
+        {
+            std::fill(worldChanged.begin(), worldChanged.end(), 0);
+        }
+
+        return 0;
+    }
+
+    unsigned int updated = 0;
+    for (SceneNode node = 0; node < nodeCount; node++)
+    {
+        const SceneNode parent = parents[node];
+        const bool parentChanged = parent != InvalidSceneNode && worldChanged[parent];
+
+        if (!localDirty[node] && !parentChanged)
+        {
+            worldChanged[node] = 0;
+            continue;
+        }
+
+        const glm::mat4x4 local = ComposeLocal(node);
+        worldMatrices[node] = parent != InvalidSceneNode ? worldMatrices[parent] * local : local;
+
+        localDirty[node] = 0;
+        worldChanged[node] = 1;
+        updated++;
+    }
+
+    anyDirty = false;
+    return updated;
+}
+
+void SceneGraph::MarkDirty(SceneNode node)
+{
+    localDirty[node] = 1;
+    anyDirty = true;
+}
+
+glm::mat4x4 SceneGraph::ComposeLocal(SceneNode node) const
+{
+    // translation * rotation * scale without the two full matrix products
+    const glm::mat3x3 rotation = glm::mat3_cast(rotations[node]);
+    const glm::vec3& scale = scales[node];
+
+    glm::mat4x4 local(1.0f);
+    local[0] = glm::vec4(rotation[0] * scale.x, 0.0f);
+    local[1] = glm::vec4(rotation[1] * scale.y, 0.0f);
+    local[2] = glm::vec4(rotation[2] * scale.z, 0.0f);
+    local[3] = glm::vec4(translations[node], 1.0f);
+
+    return local;
+}
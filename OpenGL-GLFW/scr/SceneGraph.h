@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+using SceneNode = unsigned int;
+constexpr SceneNode InvalidSceneNode = 0xFFFFFFFF;
+
+// Transform hierarchy kept in flat arrays. Parents are always created before their children,
+// so one forward pass over the arrays visits every parent before its children.
+class SceneGraph
+{
+public:
+    SceneGraph() = default;
+    ~SceneGraph() = default;
+
+    SceneNode CreateNode(SceneNode parent = InvalidSceneNode);
+
+    // Setters only mark the node dirty when the value actually changes
+    void SetTranslation(SceneNode node, const glm::vec3& translation);
+    void SetRotation(SceneNode node, const glm::quat& rotation);
+    void SetScale(SceneNode node, const glm::vec3& scale);
+
+    const glm::vec3& GetTranslation(SceneNode node) const { return translations[node]; }
+    const glm::quat& GetRotation(SceneNode node) const { return rotations[node]; }
+    const glm::vec3& GetScale(SceneNode node) const { return scales[node]; }
+    SceneNode GetParent(SceneNode node) const { return parents[node]; }
+
+    // Recomputes world matrices of dirty nodes and their descendants, returns how many were rebuilt
+    unsigned int UpdateTransforms();
+
+    const glm::mat4x4& GetWorldMatrix(SceneNode node) const { return worldMatrices[node]; }
+    // Contiguous, indexed by node, ready to be streamed into an instance or uniform buffer
+    const glm::mat4x4* GetWorldMatrices() const { return worldMatrices.data(); }
+    // True for nodes whose world matrix changed during the last UpdateTransforms
+    bool WasUpdated(SceneNode node) const { return worldChanged[node] != 0; }
+    unsigned int GetNodeCount() const { return static_cast<unsigned int>(parents.size()); }
+
+private:
+    void MarkDirty(SceneNode node);
+    glm::mat4x4 ComposeLocal(SceneNode node) const;
+
+    std::vector<SceneNode> parents;
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4x4> worldMatrices;
+    std::vector<unsigned char> localDirty;
+    std::vector<unsigned char> worldChanged;
+    bool anyDirty = false;
+};
@@ -5,6 +5,8 @@
 #include <string>
 #include <sstream>
 
+#include "CameraBuffer.h"
+#include "GLStateCache.h"
 #include "Renderer.h"
 
 Shader::Shader(std::string&& filePath)
@@ -13,21 +15,29 @@ Shader::Shader(std::string&& filePath)
     const ShaderProgramSources sources = ParseShader(this->filePath);
     // std::cout << "VERTEX: \n" << sources.VertexSource << "\nFRAGMENT: \n" << sources.FragmentSource << "\n"; 
     rendererId = CreateShader(sources.VertexSource, sources.FragmentSource);
+
+    // programs declaring the Camera block read it from the shared per frame buffer
+    GLCall(const unsigned int cameraBlock = glGetUniformBlockIndex(rendererId, CameraBuffer::BlockName))
+    if (cameraBlock != GL_INVALID_INDEX)
+    {
+        GLCall(glUniformBlockBinding(rendererId, cameraBlock, CameraBuffer::BindingPoint))
+    }
 }
 
 Shader::~Shader()
 {
     GLCall(glDeleteProgram(rendererId))
+    GLStateCache::OnProgramDeleted(rendererId);
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(rendererId))
+    GLStateCache::UseProgram(rendererId);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0))
+    GLStateCache::UseProgram(0);
 }
 
 void Shader::SetUniform1i(const std::string& name, int value)
@@ -35,6 +45,11 @@ void Shader::SetUniform1i(const std::string& name, int value)
     GLCall(glUniform1i(GetUniformLocation(name), value))
 }
 
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
+{
+    GLCall(glUniform1iv(GetUniformLocation(name), count, values))
+}
+
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
     GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3))
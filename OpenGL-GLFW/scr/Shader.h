@@ -20,8 +20,11 @@ public:
     void Bind() const;
     void Unbind() const;
 
+    unsigned int GetRendererId() const { return rendererId; }
+
     // Set Uniforms
     void SetUniform1i(const std::string& name, int value);
+    void SetUniform1iv(const std::string& name, int count, const int* values);
     void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
     void SetUniformMatrix4f(const std::string& name, glm::mat4x4 matrix);
 
@@ -0,0 +1,154 @@
+﻿#include "StreamBuffer.h"
+
+#include <cstring>
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+    : target(target), rendererId(0), regionSize(regionSize), regionCount(regionCount),
+      currentRegion(0), regionOffset(0), mappedData(nullptr), fences(regionCount, nullptr)
+{
+    ASSERT(regionCount > 0)
+
+    const unsigned int size = regionSize * regionCount;
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        // 4.5 includes buffer storage, so the named path is always persistent
+        const unsigned int flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glCreateBuffers(1, &rendererId))
+        GLCall(glNamedBufferStorage(rendererId, size, nullptr, flags))
+        GLCall(mappedData = static_cast<unsigned char*>(glMapNamedBufferRange(rendererId, 0, size, flags)))
+        return;
+    }
+
+    GLCall(glGenBuffers(1, &rendererId))
+    Bind();
+
+    if (SupportsPersistentMapping())
+    {
+        const unsigned int flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(target, size, nullptr, flags))
+        GLCall(mappedData = static_cast<unsigned char*>(glMapBufferRange(target, 0, size, flags)))
+    }
+    else
+    {
+        GLCall(glBufferData(target, size, nullptr, GL_STREAM_DRAW))
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (void* fence : fences)
+    {
+        if (fence)
+        {
+            GLCall(glDeleteSync(static_cast<GLsync>(fence)))
+        }
+    }
+
+    if (mappedData && Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glUnmapNamedBuffer(rendererId))
+    }
+    else if (mappedData)
+    {
+        Bind();
+        GLCall(glUnmapBuffer(target))
+    }
+
+    GLCall(glDeleteBuffers(1, &rendererId))
+    GLStateCache::OnBufferDeleted(rendererId);
+}
+
+unsigned int StreamBuffer::Write(const void* data, unsigned int size, unsigned int alignment)
+{
+    ASSERT(size <= regionSize)
+
+    // align the absolute offset, alignment does not have to be a power of two (e.g. a vertex stride)
+    const unsigned int regionStart = currentRegion * regionSize;
+    unsigned int offset = (regionStart + regionOffset + alignment - 1) / alignment * alignment;
+
+    if (offset + size > regionStart + regionSize)
+    {
+        NextRegion();
+        offset = (currentRegion * regionSize + alignment - 1) / alignment * alignment;
+        ASSERT(offset + size <= currentRegion * regionSize + regionSize)
+    }
+
+    if (mappedData)
+    {
+        std::memcpy(mappedData + offset, data, size);
+    }
+    else
+    {
+        // the fence already guarantees the GPU is done with this range
+        Bind();
+        GLCall(void* destination = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT))
+        std::memcpy(destination, data, size);
+        GLCall(glUnmapBuffer(target))
+    }
+
+    regionOffset = offset + size - currentRegion * regionSize;
+    stats.bytesWritten += size;
+
+    return offset;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (regionOffset > 0)
+    {
+        NextRegion();
+    }
+}
+
+void StreamBuffer::Bind() const
+{
+    GLStateCache::BindBuffer(target, rendererId);
+}
+
+void StreamBuffer::Unbind() const
+{
+    GLStateCache::BindBuffer(target, 0);
+}
+
+bool StreamBuffer::SupportsPersistentMapping()
+{
+    return GLEW_ARB_buffer_storage != 0;
+}
+
+void StreamBuffer::NextRegion()
+{
+    GLCall(fences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+
+    currentRegion = (currentRegion + 1) % regionCount;
+    regionOffset = 0;
+
+    GLsync fence = static_cast<GLsync>(fences[currentRegion]);
+    if (!fence)
+    {
+        return;
+    }
+
+    GLCall(GLenum result = glClientWaitSync(fence, 0, 0))
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        stats.fenceWaits++;
+
+        // flush once so the fence is guaranteed to signal, then block in 1 ms slices
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do
+        {
+            GLCall(result = glClientWaitSync(fence, flags, 1000000))
+            flags = 0;
+        }
+        while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    ASSERT(result != GL_WAIT_FAILED)
+
+    GLCall(glDeleteSync(fence))
+    fences[currentRegion] = nullptr;
+}
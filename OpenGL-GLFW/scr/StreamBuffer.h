@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <vector>
+
+struct StreamBufferStats
+{
+    unsigned int bytesWritten = 0;
+    // times the CPU caught up with the GPU and had to wait on a region fence
+    unsigned int fenceWaits = 0;
+};
+
+// Ring of regions inside one buffer that dynamic data is appended to every frame. With
+// ARB_buffer_storage the buffer stays mapped persistently and writes are plain memcpy, otherwise each
+// write maps its range unsynchronized. Either way a region is fenced when the ring leaves it and only
+// reused once the GPU passed that fence, so the driver never has to reallocate or sync implicitly.
+class StreamBuffer
+{
+public:
+    StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3);
+    ~StreamBuffer();
+
+    // Copies size bytes into the current region and returns their offset from the start of the buffer,
+    // a multiple of alignment. Moves on to the next region early when the current one is full.
+    unsigned int Write(const void* data, unsigned int size, unsigned int alignment = 4);
+    // Call once the frame's draws reading from the buffer have been issued
+    void EndFrame();
+
+    void Bind() const;
+    void Unbind() const;
+
+    bool IsPersistent() const { return mappedData != nullptr; }
+    unsigned int GetRendererId() const { return rendererId; }
+    const StreamBufferStats& GetStats() const { return stats; }
+    void ResetStats() { stats = StreamBufferStats(); }
+
+    static bool SupportsPersistentMapping();
+
+private:
+    void NextRegion();
+
+    unsigned int target;
+    unsigned int rendererId;
+    unsigned int regionSize;
+    unsigned int regionCount;
+    unsigned int currentRegion;
+    // write position inside the current region
+    unsigned int regionOffset;
+    unsigned char* mappedData;
+    // one GLsync per region, null while the region is not in flight
+    std::vector<void*> fences;
+    StreamBufferStats stats;
+};
@@ -1,23 +1,59 @@
 ﻿#include "Texture.h"
 
+#include <algorithm>
+
+#include "GLStateCache.h"
+#include "MipChainBuilder.h"
 #include "STB_IMAGE/stb_image.h"
 
-Texture::Texture(std::string&& path)
-    : rendererId(0), localBuffer(nullptr), width(0), height(0), bitsPerPixel(0), filePath(std::move(path))
+namespace
+{
+    // glTexImage2D wants a client format and type matching the internal format even without data
+    void GetUploadFormat(unsigned int internalFormat, unsigned int& format, unsigned int& type)
+    {
+        switch (internalFormat)
+        {
+            case GL_DEPTH_COMPONENT16:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32F:
+                format = GL_DEPTH_COMPONENT;
+                type = GL_FLOAT;
+                return;
+            case GL_DEPTH24_STENCIL8:
+                format = GL_DEPTH_STENCIL;
+                type = GL_UNSIGNED_INT_24_8;
+                return;
+            case GL_RGBA16F:
+            case GL_RGBA32F:
+            case GL_R11F_G11F_B10F:
+                format = GL_RGBA;
+                type = GL_FLOAT;
+                return;
+        }
+
+        format = GL_RGBA;
+        type = GL_UNSIGNED_BYTE;
+    }
+}
+
+Texture::Texture(std::string&& path, TextureMipmaps mipmaps)
+    : rendererId(0), localBuffer(nullptr), width(0), height(0), bitsPerPixel(0), internalFormat(GL_RGBA8), target(GL_TEXTURE_2D), layerCount(1),
+      levelCount(1), filePath(std::move(path))
 {
     stbi_set_flip_vertically_on_load(1);
     localBuffer = stbi_load(filePath.c_str(), &width, &height, &bitsPerPixel, 4);
-    
-    GLCall(glGenTextures(1, &rendererId))
-    GLCall(glBindTexture(GL_TEXTURE_2D, rendererId))
 
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR))
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR))
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE))
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE))
+    if (localBuffer && mipmaps == TextureMipmaps::Allocate)
+    {
+        levelCount = MipChainBuilder::GetLevelCount(width, height);
+    }
+    
+    Create(localBuffer, GL_RGBA, GL_UNSIGNED_BYTE);
 
-    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, localBuffer))
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0))
+    if (levelCount > 1)
+    {
+        GenerateMipmaps();
+    }
 
     if (localBuffer)
     {
@@ -25,18 +61,254 @@ Texture::Texture(std::string&& path)
     }
 }
 
+Texture::Texture(int width, int height, unsigned int internalFormat, TextureMipmaps mipmaps)
+    : rendererId(0), localBuffer(nullptr), width(width), height(height), bitsPerPixel(0), internalFormat(internalFormat),
+      target(GL_TEXTURE_2D), layerCount(1),
+      levelCount(mipmaps == TextureMipmaps::Allocate ? MipChainBuilder::GetLevelCount(width, height) : 1)
+{
+    unsigned int format;
+    unsigned int type;
+    GetUploadFormat(internalFormat, format, type);
+
+    Create(nullptr, format, type);
+}
+
+Texture::Texture(ArrayStorage, int width, int height, unsigned int internalFormat, unsigned int layers)
+    : rendererId(0), localBuffer(nullptr), width(width), height(height), bitsPerPixel(0), internalFormat(internalFormat),
+      target(GL_TEXTURE_2D_ARRAY), layerCount(layers), levelCount(1)
+{
+    ASSERT(layers > 0)
+
+    freeLayers.reserve(layers);
+    for (unsigned int layer = layers; layer > 0; layer--)
+    {
+        freeLayers.push_back(layer - 1);
+    }
+
+    unsigned int format;
+    unsigned int type;
+    GetUploadFormat(internalFormat, format, type);
+
+    Create(nullptr, format, type);
+}
+
 Texture::~Texture()
 {
     GLCall(glDeleteTextures(1, &rendererId))
+    GLStateCache::OnTextureDeleted(rendererId);
+}
+
+std::unique_ptr<Texture> Texture::CreateArray(int width, int height, unsigned int internalFormat, unsigned int layers)
+{
+    return std::unique_ptr<Texture>(new Texture(ArrayStorage(), width, height, internalFormat, layers));
+}
+
+void Texture::Create(const void* data, unsigned int format, unsigned int type)
+{
+    const bool array = target == GL_TEXTURE_2D_ARRAY;
+
+    // a failed load leaves a 0 x 0 image, which immutable storage refuses
+    if (Renderer::SupportsDirectStateAccess() && width > 0 && height > 0)
+    {
+        GLCall(glCreateTextures(target, 1, &rendererId))
+
+        GLCall(glTextureParameteri(rendererId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE))
+        GLCall(glTextureParameteri(rendererId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE))
+
+        if (array)
+        {
+            GLCall(glTextureStorage3D(rendererId, levelCount, internalFormat, width, height, layerCount))
+        }
+        else
+        {
+            GLCall(glTextureStorage2D(rendererId, levelCount, internalFormat, width, height))
+            if (data)
+            {
+                GLCall(glTextureSubImage2D(rendererId, 0, 0, 0, width, height, format, type, data))
+            }
+        }
+
+        SetSampling(sampling);
+        return;
+    }
+
+    GLCall(glGenTextures(1, &rendererId))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, rendererId);
+
+    GLCall(glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE))
+    GLCall(glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE))
+    // mutable storage is only complete up to the levels that were specified
+    GLCall(glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<int>(levelCount) - 1))
+
+    if (array)
+    {
+        GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layerCount, 0, format, type, nullptr))
+    }
+    else
+    {
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data))
+        for (unsigned int level = 1; level < levelCount; level++)
+        {
+            GLCall(glTexImage2D(GL_TEXTURE_2D, level, internalFormat, std::max(1, width >> level), std::max(1, height >> level), 0, format, type, nullptr))
+        }
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, 0);
+    SetSampling(sampling);
+}
+
+void Texture::SetData(const void* data, unsigned int format, unsigned int type)
+{
+    SetSubData(0, 0, width, height, data, format, type);
+}
+
+void Texture::SetSubData(int x, int y, int width, int height, const void* data, unsigned int format, unsigned int type)
+{
+    ASSERT(target == GL_TEXTURE_2D)
+    ASSERT(x >= 0 && y >= 0 && x + width <= this->width && y + height <= this->height)
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glTextureSubImage2D(rendererId, 0, x, y, width, height, format, type, data))
+        return;
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D, rendererId);
+    GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, data))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D, 0);
+}
+
+void Texture::SetLevelData(unsigned int level, const void* data, unsigned int format, unsigned int type)
+{
+    ASSERT(target == GL_TEXTURE_2D && level < levelCount)
+
+    const int levelWidth = std::max(1, width >> level);
+    const int levelHeight = std::max(1, height >> level);
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glTextureSubImage2D(rendererId, level, 0, 0, levelWidth, levelHeight, format, type, data))
+        return;
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D, rendererId);
+    GLCall(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight, format, type, data))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D, 0);
+}
+
+void Texture::GenerateMipmaps()
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glGenerateTextureMipmap(rendererId))
+        return;
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, rendererId);
+    GLCall(glGenerateMipmap(target))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, 0);
+}
+
+void Texture::SetSampling(const TextureSampling& sampling)
+{
+    this->sampling = sampling;
+
+    const bool mipmapped = levelCount > 1;
+    int minFilter = GL_LINEAR;
+    int magFilter = GL_LINEAR;
+
+    switch (sampling.filter)
+    {
+        case TextureFilter::Nearest:
+            minFilter = mipmapped ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+            magFilter = GL_NEAREST;
+            break;
+        case TextureFilter::Bilinear:
+            minFilter = mipmapped ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR;
+            break;
+        case TextureFilter::Trilinear:
+            minFilter = mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+            break;
+    }
+
+    const float maxAnisotropy = GetMaxAnisotropy();
+    const float anisotropy = std::min(std::max(sampling.anisotropy, 1.0f), maxAnisotropy);
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glTextureParameteri(rendererId, GL_TEXTURE_MIN_FILTER, minFilter))
+        GLCall(glTextureParameteri(rendererId, GL_TEXTURE_MAG_FILTER, magFilter))
+        if (maxAnisotropy > 1.0f)
+        {
+            GLCall(glTextureParameterf(rendererId, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy))
+        }
+        return;
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, rendererId);
+    GLCall(glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter))
+    GLCall(glTexParameteri(target, GL_TEXTURE_MAG_FILTER, magFilter))
+    if (maxAnisotropy > 1.0f)
+    {
+        GLCall(glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy))
+    }
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, 0);
+}
+
+float Texture::GetMaxAnisotropy()
+{
+    if (!GLEW_ARB_texture_filter_anisotropic && !GLEW_EXT_texture_filter_anisotropic)
+    {
+        return 1.0f;
+    }
+
+    float maxAnisotropy = 1.0f;
+    GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy))
+    return maxAnisotropy;
+}
+
+unsigned int Texture::AllocateLayer()
+{
+    ASSERT(target == GL_TEXTURE_2D_ARRAY)
+
+    if (freeLayers.empty())
+    {
+        return InvalidLayer;
+    }
+
+    const unsigned int layer = freeLayers.back();
+    freeLayers.pop_back();
+    return layer;
+}
+
+void Texture::FreeLayer(unsigned int layer)
+{
+    ASSERT(target == GL_TEXTURE_2D_ARRAY && layer < layerCount)
+
+    freeLayers.push_back(layer);
+}
+
+void Texture::SetLayerData(unsigned int layer, const void* data, unsigned int format, unsigned int type)
+{
+    ASSERT(target == GL_TEXTURE_2D_ARRAY && layer < layerCount)
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glTextureSubImage3D(rendererId, 0, 0, 0, layer, width, height, 1, format, type, data))
+        return;
+    }
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D_ARRAY, rendererId);
+    GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, type, data))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_2D_ARRAY, 0);
 }
 
 void Texture::Bind(unsigned slot) const
 {
-    GLCall(glActiveTexture(GL_TEXTURE0 + slot))
-    GLCall(glBindTexture(GL_TEXTURE_2D, rendererId))
+    GLStateCache::BindTexture(slot, target, rendererId);
 }
 
 void Texture::Unbind()
 {
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0))
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), target, 0);
 }
@@ -1,26 +1,98 @@
 ﻿#pragma once
 
+#include <memory>
+#include <vector>
+
 #include "Renderer.h"
 
+// None is a single level, Allocate reserves the full chain for GenerateMipmaps or SetLevelData
+enum class TextureMipmaps
+{
+    None,
+    Allocate,
+};
+
+enum class TextureFilter
+{
+    Nearest,
+    Bilinear,
+    Trilinear,
+};
+
+struct TextureSampling
+{
+    // textures without mipmaps fall back to plain linear filtering
+    TextureFilter filter = TextureFilter::Trilinear;
+    // clamped to GetMaxAnisotropy(), 1 turns anisotropic filtering off
+    float anisotropy = 1.0f;
+};
+
 class Texture
 {
 public:
-    Texture(std::string&& path);
+    static constexpr unsigned int InvalidLayer = 0xFFFFFFFF;
+
+    // Loaded images get their mipmaps from glGenerateMipmap unless mipmaps is None
+    Texture(std::string&& path, TextureMipmaps mipmaps = TextureMipmaps::Allocate);
+    // Empty storage, e.g. a render target
+    Texture(int width, int height, unsigned int internalFormat = GL_RGBA8, TextureMipmaps mipmaps = TextureMipmaps::None);
     ~Texture();
 
+    // GL_TEXTURE_2D_ARRAY of same sized layers, shaders pick one per vertex or instance
+    // through a sampler2DArray, so differently textured objects share one draw call
+    static std::unique_ptr<Texture> CreateArray(int width, int height, unsigned int internalFormat, unsigned int layers);
+
     void Bind(unsigned int slot = 0) const;
     void Unbind();
+    // Replaces the whole image, with a pixel unpack buffer bound data is an offset into that buffer
+    void SetData(const void* data, unsigned int format = GL_RGBA, unsigned int type = GL_UNSIGNED_BYTE);
+    void SetSubData(int x, int y, int width, int height, const void* data, unsigned int format = GL_RGBA, unsigned int type = GL_UNSIGNED_BYTE);
+    // Whole level, e.g. from a chain built by MipChainBuilder
+    void SetLevelData(unsigned int level, const void* data, unsigned int format = GL_RGBA, unsigned int type = GL_UNSIGNED_BYTE);
+    // Filters every level from level 0 on the GPU, in the storage format, so RGBA8 is averaged gamma encoded
+    void GenerateMipmaps();
+    void SetSampling(const TextureSampling& sampling);
+
+    // Array textures only: hands out unused layers, InvalidLayer once all of them are taken
+    unsigned int AllocateLayer();
+    void FreeLayer(unsigned int layer);
+    void SetLayerData(unsigned int layer, const void* data, unsigned int format = GL_RGBA, unsigned int type = GL_UNSIGNED_BYTE);
 
     int GetWidth() const { return width; }
     int GetHeight() const { return height; }
+    unsigned int GetRendererId() const { return rendererId; }
+    unsigned int GetInternalFormat() const { return internalFormat; }
+    unsigned int GetTarget() const { return target; }
+    unsigned int GetLevelCount() const { return levelCount; }
+    const TextureSampling& GetSampling() const { return sampling; }
+    unsigned int GetLayerCount() const { return layerCount; }
+    unsigned int GetFreeLayerCount() const { return static_cast<unsigned int>(freeLayers.size()); }
+
+    // 1 without EXT/ARB_texture_filter_anisotropic
+    static float GetMaxAnisotropy();
     
     
 private:
+    // keeps the array constructor out of brace initialized overloads, e.g. a color passed as { r, g, b, a }
+    struct ArrayStorage {};
+
+    Texture(ArrayStorage, int width, int height, unsigned int internalFormat, unsigned int layers);
+
+    // Allocates width x height of internalFormat and uploads data when there is any
+    void Create(const void* data, unsigned int format, unsigned int type);
+
     unsigned int rendererId;
     unsigned char* localBuffer;
     int width;
     int height;
     int bitsPerPixel;
+    unsigned int internalFormat;
+    unsigned int target;
+    unsigned int layerCount;
+    unsigned int levelCount;
+    TextureSampling sampling;
+    // popped from the back, so layers are handed out in ascending order
+    std::vector<unsigned int> freeLayers;
     std::string filePath;
     
 };
@@ -0,0 +1,273 @@
+﻿#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ImGui compiles the non static implementation into imgui_draw.cpp, this private copy
+// keeps the atlas independent of how ImGui is built
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "Vendor/imstb_rectpack.h"
+
+struct TextureAtlas::PackState
+{
+    stbrp_context context;
+    // one node per column lets the skyline packer place rects at any x
+    std::vector<stbrp_node> nodes;
+};
+
+TextureAtlas::TextureAtlas(int pageSize, unsigned int maxPages, int padding)
+    : pageSize(pageSize), maxPages(maxPages), padding(padding), frame(0), nextHandle(0)
+{
+    ASSERT(maxPages > 0)
+}
+
+TextureAtlas::~TextureAtlas() = default;
+
+unsigned int TextureAtlas::Add(const unsigned char* pixels, int width, int height)
+{
+    const int paddedWidth = width + 2 * padding;
+    const int paddedHeight = height + 2 * padding;
+    if (paddedWidth > pageSize || paddedHeight > pageSize)
+    {
+        std::cout << "WARNING: " << width << "x" << height << " image does not fit a " << pageSize << " atlas page" << std::endl;
+        return InvalidHandle;
+    }
+
+    Entry entry {};
+    entry.width = width;
+    entry.height = height;
+    entry.lastUsed = frame;
+
+    // extrude the edge texels into the padding so linear filtering at the border samples the image itself
+    entry.paddedPixels.resize(static_cast<size_t>(paddedWidth) * paddedHeight * 4);
+    for (int y = 0; y < paddedHeight; y++)
+    {
+        const int sourceY = std::min(std::max(y - padding, 0), height - 1);
+        for (int x = 0; x < paddedWidth; x++)
+        {
+            const int sourceX = std::min(std::max(x - padding, 0), width - 1);
+            std::memcpy(&entry.paddedPixels[(static_cast<size_t>(y) * paddedWidth + x) * 4], &pixels[(static_cast<size_t>(sourceY) * width + sourceX) * 4], 4);
+        }
+    }
+
+    const unsigned int handle = nextHandle++;
+
+    for (unsigned int page = 0; page < pages.size(); page++)
+    {
+        if (PackInto(page, entry))
+        {
+            entries.emplace(handle, std::move(entry));
+            stats.entries = static_cast<unsigned int>(entries.size());
+            return handle;
+        }
+    }
+
+    if (pages.size() < maxPages)
+    {
+        AddPage();
+        const bool packed = PackInto(static_cast<unsigned int>(pages.size() - 1), entry);
+        ASSERT(packed)
+
+        entries.emplace(handle, std::move(entry));
+        stats.entries = static_cast<unsigned int>(entries.size());
+        return handle;
+    }
+
+    // every page is full: reclaim the space of removed images before evicting anything
+    while (!fragmentedPages.empty())
+    {
+        const unsigned int page = fragmentedPages.back();
+        if (Repack(page, &entry))
+        {
+            entries.emplace(handle, std::move(entry));
+            stats.entries = static_cast<unsigned int>(entries.size());
+            return handle;
+        }
+
+        // still compacts the page, its remaining images always fit
+        Repack(page, nullptr);
+    }
+
+    // evict the least recently used images until one page repacks with room for this one
+    std::vector<unsigned int> failedPages;
+    bool added = false;
+
+    while (!added)
+    {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->second.lastUsed < frame && (victim == entries.end() || it->second.lastUsed < victim->second.lastUsed))
+            {
+                victim = it;
+            }
+        }
+
+        if (victim == entries.end())
+        {
+            std::cout << "WARNING: Texture atlas is full, every image is in use this frame" << std::endl;
+            break;
+        }
+
+        const unsigned int page = victim->second.page;
+        entries.erase(victim);
+        stats.evictions++;
+
+        added = Repack(page, &entry);
+        if (added)
+        {
+            entries.emplace(handle, std::move(entry));
+            failedPages.erase(std::remove(failedPages.begin(), failedPages.end(), page), failedPages.end());
+        }
+        else if (std::find(failedPages.begin(), failedPages.end(), page) == failedPages.end())
+        {
+            failedPages.push_back(page);
+        }
+    }
+
+    // a failed attempt leaves the packer in an unusable state, settle those pages without the new image
+    for (unsigned int page : failedPages)
+    {
+        Repack(page, nullptr);
+    }
+
+    stats.entries = static_cast<unsigned int>(entries.size());
+    return added ? handle : InvalidHandle;
+}
+
+void TextureAtlas::Remove(unsigned int handle)
+{
+    const auto it = entries.find(handle);
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    // the space is reclaimed the next time the page gets repacked
+    const unsigned int page = it->second.page;
+    if (std::find(fragmentedPages.begin(), fragmentedPages.end(), page) == fragmentedPages.end())
+    {
+        fragmentedPages.push_back(page);
+    }
+
+    entries.erase(it);
+    stats.entries = static_cast<unsigned int>(entries.size());
+}
+
+const AtlasRegion* TextureAtlas::Get(unsigned int handle)
+{
+    const auto it = entries.find(handle);
+    if (it == entries.end())
+    {
+        return nullptr;
+    }
+
+    it->second.lastUsed = frame;
+    return &it->second.region;
+}
+
+void TextureAtlas::AddPage()
+{
+    Page page;
+    page.texture.reset(new Texture(pageSize, pageSize, GL_RGBA8));
+    page.packer.reset(new PackState());
+    page.packer->nodes.resize(pageSize);
+
+    pages.push_back(std::move(page));
+    ResetPacker(static_cast<unsigned int>(pages.size() - 1));
+    stats.pages = static_cast<unsigned int>(pages.size());
+}
+
+void TextureAtlas::ResetPacker(unsigned int page)
+{
+    PackState& packer = *pages[page].packer;
+    stbrp_init_target(&packer.context, pageSize, pageSize, packer.nodes.data(), static_cast<int>(packer.nodes.size()));
+}
+
+bool TextureAtlas::PackInto(unsigned int page, Entry& entry)
+{
+    stbrp_rect rect {};
+    rect.w = entry.width + 2 * padding;
+    rect.h = entry.height + 2 * padding;
+    stbrp_pack_rects(&pages[page].packer->context, &rect, 1);
+
+    if (!rect.was_packed)
+    {
+        return false;
+    }
+
+    Place(entry, page, rect.x, rect.y);
+    return true;
+}
+
+bool TextureAtlas::Repack(unsigned int page, Entry* extra)
+{
+    std::vector<stbrp_rect> rects;
+    for (const auto& it : entries)
+    {
+        if (it.second.page == page)
+        {
+            stbrp_rect rect {};
+            rect.id = static_cast<int>(it.first);
+            rect.w = it.second.width + 2 * padding;
+            rect.h = it.second.height + 2 * padding;
+            rects.push_back(rect);
+        }
+    }
+
+    if (extra)
+    {
+        stbrp_rect rect {};
+        rect.id = -1;
+        rect.w = extra->width + 2 * padding;
+        rect.h = extra->height + 2 * padding;
+        rects.push_back(rect);
+    }
+
+    ResetPacker(page);
+    const bool allPacked = stbrp_pack_rects(&pages[page].packer->context, rects.data(), static_cast<int>(rects.size())) != 0;
+    if (extra && !allPacked)
+    {
+        return false;
+    }
+
+    stats.repacks++;
+    fragmentedPages.erase(std::remove(fragmentedPages.begin(), fragmentedPages.end(), page), fragmentedPages.end());
+
+    for (const stbrp_rect& rect : rects)
+    {
+        if (rect.id < 0)
+        {
+            Place(*extra, page, rect.x, rect.y);
+        }
+        else if (rect.was_packed)
+        {
+            Place(entries.at(static_cast<unsigned int>(rect.id)), page, rect.x, rect.y);
+        }
+        else
+        {
+            entries.erase(static_cast<unsigned int>(rect.id));
+            stats.evictions++;
+        }
+    }
+
+    stats.entries = static_cast<unsigned int>(entries.size());
+    return true;
+}
+
+void TextureAtlas::Place(Entry& entry, unsigned int page, int x, int y)
+{
+    const Texture& texture = *pages[page].texture;
+    const float scale = 1.0f / static_cast<float>(pageSize);
+
+    entry.page = page;
+    entry.x = x;
+    entry.y = y;
+    entry.region.texture = &texture;
+    entry.region.uvMin = glm::vec2(x + padding, y + padding) * scale;
+    entry.region.uvMax = glm::vec2(x + padding + entry.width, y + padding + entry.height) * scale;
+
+    pages[page].texture->SetSubData(x, y, entry.width + 2 * padding, entry.height + 2 * padding, entry.paddedPixels.data());
+}
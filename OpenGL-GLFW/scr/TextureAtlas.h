@@ -0,0 +1,93 @@
+﻿#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <GLM/glm.hpp>
+
+#include "Texture.h"
+
+struct AtlasRegion
+{
+    const Texture* texture;
+    glm::vec2 uvMin;
+    glm::vec2 uvMax;
+};
+
+struct AtlasStats
+{
+    unsigned int entries = 0;
+    unsigned int pages = 0;
+    unsigned int evictions = 0;
+    unsigned int repacks = 0;
+};
+
+// Packs many small RGBA images (sprites, icons, glyphs) into a few large pages with stb_rect_pack, so
+// the batch renderer draws them without texture switches. Once every page is full, pages with removed
+// images are repacked first, then the least recently used images are evicted and their page is repacked.
+// Repacking may move the images that stay: regions are only valid until the next Add(), so add images
+// before the frame's draws and Get() them per frame.
+class TextureAtlas
+{
+public:
+    static constexpr unsigned int InvalidHandle = 0xFFFFFFFF;
+
+    // padding is the border around each image, filled with its edge texels against filtering bleed
+    TextureAtlas(int pageSize = 2048, unsigned int maxPages = 4, int padding = 1);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Copies the pixels, returns InvalidHandle when the image does not fit a page or nothing can be evicted
+    unsigned int Add(const unsigned char* pixels, int width, int height);
+    void Remove(unsigned int handle);
+    // Null once the image got evicted, otherwise marks it as used this frame
+    const AtlasRegion* Get(unsigned int handle);
+    // Images used in the current frame are never evicted
+    void NextFrame() { frame++; }
+
+    const AtlasStats& GetStats() const { return stats; }
+
+private:
+    struct PackState;
+
+    struct Page
+    {
+        std::unique_ptr<Texture> texture;
+        std::unique_ptr<PackState> packer;
+    };
+
+    struct Entry
+    {
+        unsigned int page;
+        // position of the padded image inside the page
+        int x;
+        int y;
+        int width;
+        int height;
+        std::vector<unsigned char> paddedPixels;
+        unsigned int lastUsed;
+        AtlasRegion region;
+    };
+
+    void AddPage();
+    void ResetPacker(unsigned int page);
+    bool PackInto(unsigned int page, Entry& entry);
+    // Packs the page's entries from scratch, plus extra when given. Without extra, entries that no
+    // longer fit are evicted; with extra nothing changes unless everything fits.
+    bool Repack(unsigned int page, Entry* extra);
+    void Place(Entry& entry, unsigned int page, int x, int y);
+
+    int pageSize;
+    unsigned int maxPages;
+    int padding;
+    unsigned int frame;
+    unsigned int nextHandle;
+    std::vector<Page> pages;
+    // pages with holes left by Remove(), the packer only gets that space back through a repack
+    std::vector<unsigned int> fragmentedPages;
+    std::unordered_map<unsigned int, Entry> entries;
+    AtlasStats stats;
+};
@@ -0,0 +1,53 @@
+﻿#include "TextureBuffer.h"
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+TextureBuffer::TextureBuffer()
+    : bufferId(0), rendererId(0)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &bufferId))
+        GLCall(glCreateTextures(GL_TEXTURE_BUFFER, 1, &rendererId))
+        return;
+    }
+
+    GLCall(glGenBuffers(1, &bufferId))
+    GLCall(glGenTextures(1, &rendererId))
+}
+
+TextureBuffer::~TextureBuffer()
+{
+    GLCall(glDeleteTextures(1, &rendererId))
+    GLStateCache::OnTextureDeleted(rendererId);
+    GLCall(glDeleteBuffers(1, &bufferId))
+    GLStateCache::OnBufferDeleted(bufferId);
+}
+
+void TextureBuffer::SetData(const void* data, unsigned int size)
+{
+    // orphan the previous storage so the upload does not wait on draws still reading it
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glNamedBufferData(bufferId, size, data, GL_STREAM_DRAW))
+        GLCall(glTextureBuffer(rendererId, GL_RGBA32F, bufferId))
+        return;
+    }
+
+    GLStateCache::BindBuffer(GL_TEXTURE_BUFFER, bufferId);
+    GLCall(glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW))
+
+    GLStateCache::BindTexture(GLStateCache::GetActiveTextureSlot(), GL_TEXTURE_BUFFER, rendererId);
+    GLCall(glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, bufferId))
+}
+
+void TextureBuffer::Bind(unsigned int slot) const
+{
+    GLStateCache::BindTexture(slot, GL_TEXTURE_BUFFER, rendererId);
+}
+
+void TextureBuffer::Unbind(unsigned int slot) const
+{
+    GLStateCache::BindTexture(slot, GL_TEXTURE_BUFFER, 0);
+}
@@ -0,0 +1,18 @@
+﻿#pragma once
+
+// Buffer texture of RGBA32F texels, read in shaders through samplerBuffer/texelFetch
+class TextureBuffer
+{
+public:
+    TextureBuffer();
+    ~TextureBuffer();
+
+    void SetData(const void* data, unsigned int size);
+
+    void Bind(unsigned int slot = 0) const;
+    void Unbind(unsigned int slot = 0) const;
+
+private:
+    unsigned int bufferId;
+    unsigned int rendererId;
+};
@@ -0,0 +1,169 @@
+﻿#include "TextureLoader.h"
+
+#include <iostream>
+
+#include "STB_IMAGE/stb_image.h"
+
+TextureLoader::TextureLoader(unsigned int uploadBudget, unsigned int decodeThreads)
+    : pixelBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBudget), uploadBudget(uploadBudget), cancelled(false), pool(decodeThreads)
+{
+    // magenta and black checker, obvious on screen if a texture never finishes
+    const unsigned char checker[] = {
+        255, 0, 255, 255,   0, 0, 0, 255,
+        0, 0, 0, 255,       255, 0, 255, 255,
+    };
+
+    placeholder.reset(new Texture(2, 2, GL_RGBA8));
+    placeholder->SetData(checker);
+    placeholder->SetSampling({ TextureFilter::Nearest, 1.0f });
+}
+
+TextureLoader::~TextureLoader()
+{
+    // jobs that did not start yet skip their decode, the queues free what the others produced
+    cancelled = true;
+    pool.Wait();
+}
+
+unsigned int TextureLoader::Load(std::string&& path)
+{
+    const unsigned int handle = static_cast<unsigned int>(entries.size());
+    entries.push_back({ path, nullptr, TextureState::Loading });
+    stats.pending++;
+
+    pool.Enqueue([this, handle, path = std::move(path)]
+    {
+        DecodedImage image;
+        image.handle = handle;
+
+        if (!cancelled)
+        {
+            int width = 0;
+            int height = 0;
+            int bitsPerPixel = 0;
+            // the global flip flag is not safe to touch from several threads
+            stbi_set_flip_vertically_on_load_thread(1);
+            unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &bitsPerPixel, 4);
+
+            // the chain is built here too, the GL thread only copies finished levels
+            if (pixels)
+            {
+                image.levels = MipChainBuilder::Build(pixels, width, height);
+                stbi_image_free(pixels);
+            }
+        }
+
+        decoded.Push(std::move(image));
+    });
+
+    return handle;
+}
+
+void TextureLoader::Update()
+{
+    stats.uploadedBytes = 0;
+
+    DecodedImage image;
+    while (decoded.TryPop(image))
+    {
+        uploads.push_back(std::move(image));
+    }
+
+    while (!uploads.empty())
+    {
+        // the first upload of a frame always goes, so an image over the budget still gets through
+        const unsigned int size = GetSize(uploads.front());
+        if (stats.uploadedBytes > 0 && stats.uploadedBytes + size > uploadBudget)
+        {
+            break;
+        }
+
+        Upload(uploads.front());
+        stats.uploadedBytes += size;
+        uploads.pop_front();
+    }
+
+    pixelBuffer.EndFrame();
+}
+
+void TextureLoader::Upload(const DecodedImage& image)
+{
+    Entry& entry = entries[image.handle];
+    stats.pending--;
+
+    if (image.levels.empty())
+    {
+        std::cout << "WARNING: Failed to load texture " << entry.path << std::endl;
+        entry.state = TextureState::Failed;
+        stats.failed++;
+        return;
+    }
+
+    const MipLevel& base = image.levels[0];
+    entry.texture.reset(new Texture(base.width, base.height, GL_RGBA8, TextureMipmaps::Allocate));
+    entry.texture->SetSampling(sampling);
+
+    const bool throughPixelBuffer = GetSize(image) <= uploadBudget;
+    for (unsigned int level = 0; level < image.levels.size(); level++)
+    {
+        const std::vector<unsigned char>& pixels = image.levels[level].pixels;
+        if (throughPixelBuffer)
+        {
+            // copy into the ring, the driver then transfers from the PBO without stalling this thread
+            const unsigned int offset = pixelBuffer.Write(pixels.data(), static_cast<unsigned int>(pixels.size()), 4);
+            pixelBuffer.Bind();
+            entry.texture->SetLevelData(level, reinterpret_cast<const void*>(static_cast<size_t>(offset)));
+        }
+        else
+        {
+            entry.texture->SetLevelData(level, pixels.data());
+        }
+    }
+
+    if (throughPixelBuffer)
+    {
+        pixelBuffer.Unbind();
+    }
+
+    entry.state = TextureState::Ready;
+    stats.loaded++;
+}
+
+const Texture& TextureLoader::Get(unsigned int handle) const
+{
+    ASSERT(handle < entries.size())
+
+    const Entry& entry = entries[handle];
+    return entry.state == TextureState::Ready ? *entry.texture : *placeholder;
+}
+
+TextureState TextureLoader::GetState(unsigned int handle) const
+{
+    ASSERT(handle < entries.size())
+
+    return entries[handle].state;
+}
+
+void TextureLoader::SetSampling(const TextureSampling& sampling)
+{
+    this->sampling = sampling;
+
+    for (Entry& entry : entries)
+    {
+        if (entry.state == TextureState::Ready)
+        {
+            entry.texture->SetSampling(sampling);
+        }
+    }
+}
+
+unsigned int TextureLoader::GetSize(const DecodedImage& image)
+{
+    unsigned int size = 0;
+    for (const MipLevel& level : image.levels)
+    {
+        size += static_cast<unsigned int>(level.pixels.size());
+    }
+
+    return size;
+}
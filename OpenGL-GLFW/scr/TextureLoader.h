@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MipChainBuilder.h"
+#include "MpscQueue.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+#include "ThreadPool.h"
+
+enum class TextureState
+{
+    Loading,
+    Ready,
+    Failed,
+};
+
+struct TextureLoaderStats
+{
+    // queued for decode or waiting for their upload
+    unsigned int pending = 0;
+    unsigned int loaded = 0;
+    unsigned int failed = 0;
+    unsigned int uploadedBytes = 0;
+};
+
+// Decodes image files on its own worker threads, where it also builds their gamma correct mip chains,
+// and uploads the levels on the GL thread through a pixel unpack stream buffer, a limited amount per
+// frame. Until a texture is ready Get() returns a placeholder, so nothing ever waits on a load.
+class TextureLoader
+{
+public:
+    // uploadBudget is the bytes uploaded per Update() and the size of each PBO region,
+    // images larger than that are uploaded straight from client memory on a frame of their own
+    TextureLoader(unsigned int uploadBudget = 8 * 1024 * 1024, unsigned int decodeThreads = 0);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    unsigned int Load(std::string&& path);
+    // GL thread, once per frame
+    void Update();
+
+    const Texture& Get(unsigned int handle) const;
+    TextureState GetState(unsigned int handle) const;
+    const Texture& GetPlaceholder() const { return *placeholder; }
+    // Applies to loaded textures and the ones still to come
+    void SetSampling(const TextureSampling& sampling);
+    const TextureLoaderStats& GetStats() const { return stats; }
+
+private:
+    struct DecodedImage
+    {
+        unsigned int handle = 0;
+        // empty when stb_image could not read the file
+        std::vector<MipLevel> levels;
+    };
+
+    struct Entry
+    {
+        std::string path;
+        std::unique_ptr<Texture> texture;
+        TextureState state;
+    };
+
+    void Upload(const DecodedImage& image);
+
+    static unsigned int GetSize(const DecodedImage& image);
+
+    std::vector<Entry> entries;
+    MpscQueue<DecodedImage> decoded;
+    // decoded but over this frame's budget
+    std::deque<DecodedImage> uploads;
+    StreamBuffer pixelBuffer;
+    std::unique_ptr<Texture> placeholder;
+    unsigned int uploadBudget;
+    TextureSampling sampling;
+    std::atomic<bool> cancelled;
+    TextureLoaderStats stats;
+    ThreadPool pool;
+};
@@ -0,0 +1,79 @@
+﻿#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : pendingJobs(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    jobAvailable.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+        pendingJobs++;
+    }
+
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsFinished.wait(lock, [this] { return pendingJobs == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+            if (stopping && jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingJobs--;
+        }
+
+        jobsFinished.notify_all();
+    }
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // 0 threads means one per hardware thread, minus the one that owns the GL context
+    ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    void Enqueue(std::function<void()> job);
+    // Blocks until every job enqueued so far has finished
+    void Wait();
+
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsFinished;
+    unsigned int pendingJobs;
+    bool stopping;
+};
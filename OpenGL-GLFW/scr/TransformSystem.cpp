@@ -0,0 +1,196 @@
+﻿#include "TransformSystem.h"
+
+#include <chrono>
+#include <random>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+unsigned int TransformSystem::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    rotationX.push_back(rotation.x);
+    rotationY.push_back(rotation.y);
+    rotationZ.push_back(rotation.z);
+    rotationW.push_back(rotation.w);
+    scaleX.push_back(scale.x);
+    scaleY.push_back(scale.y);
+    scaleZ.push_back(scale.z);
+
+    return GetCount() - 1;
+}
+
+void TransformSystem::SetPosition(unsigned int index, const glm::vec3& position)
+{
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+}
+
+void TransformSystem::SetRotation(unsigned int index, const glm::quat& rotation)
+{
+    rotationX[index] = rotation.x;
+    rotationY[index] = rotation.y;
+    rotationZ[index] = rotation.z;
+    rotationW[index] = rotation.w;
+}
+
+void TransformSystem::SetScale(unsigned int index, const glm::vec3& scale)
+{
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+}
+
+void TransformSystem::Clear()
+{
+    for (std::vector<float>* component : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ })
+    {
+        component->clear();
+    }
+}
+
+void TransformSystem::ComputeModelMatrices(glm::mat4x4* out) const
+{
+    ComputeMvpMatrices(glm::mat4x4(1.0f), out);
+}
+
+void TransformSystem::ComputeMvpMatrices(const glm::mat4x4& viewProjection, glm::mat4x4* out) const
+{
+    const unsigned int count = GetCount();
+    unsigned int i = 0;
+
+#if defined(TRANSFORM_USE_SSE)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    // viewProjection[column][row] broadcast once, reused by every batch
+    __m128 vp[4][4];
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            vp[column][row] = _mm_set1_ps(viewProjection[column][row]);
+        }
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 qx = _mm_loadu_ps(&rotationX[i]);
+        const __m128 qy = _mm_loadu_ps(&rotationY[i]);
+        const __m128 qz = _mm_loadu_ps(&rotationZ[i]);
+        const __m128 qw = _mm_loadu_ps(&rotationW[i]);
+
+        const __m128 xx = _mm_mul_ps(qx, qx);
+        const __m128 yy = _mm_mul_ps(qy, qy);
+        const __m128 zz = _mm_mul_ps(qz, qz);
+        const __m128 xy = _mm_mul_ps(qx, qy);
+        const __m128 xz = _mm_mul_ps(qx, qz);
+        const __m128 yz = _mm_mul_ps(qy, qz);
+        const __m128 wx = _mm_mul_ps(qw, qx);
+        const __m128 wy = _mm_mul_ps(qw, qy);
+        const __m128 wz = _mm_mul_ps(qw, qz);
+
+        const __m128 sx = _mm_loadu_ps(&scaleX[i]);
+        const __m128 sy = _mm_loadu_ps(&scaleY[i]);
+        const __m128 sz = _mm_loadu_ps(&scaleZ[i]);
+
+        // model[column][row] for four objects, same layout as glm::mat3_cast scaled per column
+        __m128 model[4][3];
+        model[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        model[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+        model[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+        model[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+        model[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        model[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+        model[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+        model[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+        model[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+        model[3][0] = _mm_loadu_ps(&positionX[i]);
+        model[3][1] = _mm_loadu_ps(&positionY[i]);
+        model[3][2] = _mm_loadu_ps(&positionZ[i]);
+
+        for (int column = 0; column < 4; column++)
+        {
+            // result column = vp * model column, whose w is 0 for the basis vectors and 1 for the translation
+            __m128 rows[4];
+            for (int row = 0; row < 4; row++)
+            {
+                __m128 value = _mm_mul_ps(vp[0][row], model[column][0]);
+                value = _mm_add_ps(value, _mm_mul_ps(vp[1][row], model[column][1]));
+                value = _mm_add_ps(value, _mm_mul_ps(vp[2][row], model[column][2]));
+                if (column == 3)
+                {
+                    value = _mm_add_ps(value, vp[3][row]);
+                }
+
+                rows[row] = value;
+            }
+
+            // rows hold one element of four objects, transpose into one column per object
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+            for (int object = 0; object < 4; object++)
+            {
+                _mm_storeu_ps(&out[i + object][column][0], rows[object]);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        out[i] = viewProjection * ComposeScalar(i);
+    }
+}
+
+void TransformSystem::ComputeMvpMatricesScalar(const glm::mat4x4& viewProjection, glm::mat4x4* out) const
+{
+    for (unsigned int i = 0; i < GetCount(); i++)
+    {
+        out[i] = viewProjection * ComposeScalar(i);
+    }
+}
+
+glm::mat4x4 TransformSystem::ComposeScalar(unsigned int index) const
+{
+    const glm::quat rotation(rotationW[index], rotationX[index], rotationY[index], rotationZ[index]);
+    const glm::vec3 position(positionX[index], positionY[index], positionZ[index]);
+    const glm::vec3 scale(scaleX[index], scaleY[index], scaleZ[index]);
+
+    // the chain Application.cpp used to build per object
+    return glm::translate(glm::mat4x4(1.0f), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4x4(1.0f), scale);
+}
+
+TransformBenchmark TransformSystem::Benchmark(unsigned int count)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    TransformSystem transforms;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const glm::vec3 position(distribution(random) * 960.0f, distribution(random) * 540.0f, 0.0f);
+        const glm::quat rotation = glm::angleAxis(distribution(random) * 3.14159f, glm::vec3(0.0f, 0.0f, 1.0f));
+        transforms.Add(position, rotation, glm::vec3(1.0f + distribution(random)));
+    }
+
+    const glm::mat4x4 viewProjection = glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f);
+    std::vector<glm::mat4x4> results(count);
+
+    using Clock = std::chrono::high_resolution_clock;
+    TransformBenchmark benchmark { count, 0.0, 0.0 };
+
+    auto start = Clock::now();
+    transforms.ComputeMvpMatricesScalar(viewProjection, results.data());
+    benchmark.scalarMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    transforms.ComputeMvpMatrices(viewProjection, results.data());
+    benchmark.simdMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    return benchmark;
+}
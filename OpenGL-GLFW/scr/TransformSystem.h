@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <vector>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+struct TransformBenchmark
+{
+    unsigned int count;
+    double scalarMilliseconds;
+    double simdMilliseconds;
+};
+
+// Flat transforms (no hierarchy) stored as structure of arrays, so four objects can be
+// composed and multiplied per SSE iteration instead of one glm multiply chain each
+class TransformSystem
+{
+public:
+    TransformSystem() = default;
+    ~TransformSystem() = default;
+
+    unsigned int Add(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+    void SetPosition(unsigned int index, const glm::vec3& position);
+    void SetRotation(unsigned int index, const glm::quat& rotation);
+    void SetScale(unsigned int index, const glm::vec3& scale);
+    void Clear();
+
+    // out must hold GetCount() matrices
+    void ComputeModelMatrices(glm::mat4x4* out) const;
+    void ComputeMvpMatrices(const glm::mat4x4& viewProjection, glm::mat4x4* out) const;
+    // Same results through plain glm, kept as the reference and for the benchmark
+    void ComputeMvpMatricesScalar(const glm::mat4x4& viewProjection, glm::mat4x4* out) const;
+
+    unsigned int GetCount() const { return static_cast<unsigned int>(positionX.size()); }
+
+    // Times the SIMD path against the scalar glm path over count random transforms
+    static TransformBenchmark Benchmark(unsigned int count);
+
+private:
+    glm::mat4x4 ComposeScalar(unsigned int index) const;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> rotationX;
+    std::vector<float> rotationY;
+    std::vector<float> rotationZ;
+    std::vector<float> rotationW;
+    std::vector<float> scaleX;
+    std::vector<float> scaleY;
+    std::vector<float> scaleZ;
+};
@@ -0,0 +1,54 @@
+﻿#include "UniformBuffer.h"
+
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int bindingPoint)
+    : rendererId(0), size(size), bindingPoint(bindingPoint)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &rendererId))
+        GLCall(glNamedBufferData(rendererId, size, nullptr, GL_DYNAMIC_DRAW))
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &rendererId))
+        Bind();
+        GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW))
+    }
+
+    // also sets the generic binding to this buffer, Bind() brings the cache in line with it
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, rendererId))
+    Bind();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLCall(glDeleteBuffers(1, &rendererId))
+    GLStateCache::OnBufferDeleted(rendererId);
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= this->size)
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glNamedBufferSubData(rendererId, offset, size, data))
+        return;
+    }
+
+    Bind();
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data))
+}
+
+void UniformBuffer::Bind() const
+{
+    GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, rendererId);
+}
+
+void UniformBuffer::Unbind() const
+{
+    GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
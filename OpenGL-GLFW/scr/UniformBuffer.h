@@ -0,0 +1,21 @@
+﻿#pragma once
+
+// Uniform buffer object attached to one indexed binding point for its whole lifetime
+class UniformBuffer
+{
+public:
+    UniformBuffer(unsigned int size, unsigned int bindingPoint);
+    ~UniformBuffer();
+
+    void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+    void Bind() const;
+    void Unbind() const;
+
+    unsigned int GetBindingPoint() const { return bindingPoint; }
+
+private:
+    unsigned int rendererId;
+    unsigned int size;
+    unsigned int bindingPoint;
+};
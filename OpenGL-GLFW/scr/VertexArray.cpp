@@ -1,44 +1,212 @@
 ﻿#include "VertexArray.h"
 #include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "StreamBuffer.h"
+#include "GLStateCache.h"
 #include "Renderer.h"
 
 VertexArray::VertexArray()
+    : attributeCount(0), bufferCount(0)
 {
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glCreateVertexArrays(1, &rendererId))
+        return;
+    }
+
     GLCall(glGenVertexArrays(1, &rendererId))
 }
 
 VertexArray::~VertexArray()
 {
     GLCall(glDeleteVertexArrays(1, &rendererId))
+    GLStateCache::OnVertexArrayDeleted(rendererId);
 }
 
 void VertexArray::Bind() const
 {
-    GLCall(glBindVertexArray(rendererId))
+    GLStateCache::BindVertexArray(rendererId);
 }
 
 void VertexArray::Unbind() const
 {
-    GLCall(glBindVertexArray(0))
+    GLStateCache::BindVertexArray(0);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+    AttachBuffer(vb.GetRendererId(), layout.GetStride());
+    AddAttributes(layout);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+    AttachBuffer(sb.GetRendererId(), layout.GetStride());
+    AddAttributes(layout);
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glVertexArrayElementBuffer(rendererId, ib.GetRendererId()))
+        GLStateCache::OnElementBufferChanged(rendererId);
+        return;
+    }
+
     Bind();
-    vb.Bind();
+    ib.Bind();
+}
+
+void VertexArray::AttachBuffer(unsigned int buffer, unsigned int stride)
+{
+    const unsigned int bindingIndex = bufferCount++;
+
+    if (Renderer::SupportsDirectStateAccess())
+    {
+        GLCall(glVertexArrayVertexBuffer(rendererId, bindingIndex, buffer, 0, stride))
+        return;
+    }
+
+    // glVertexAttribPointer captures whatever is bound to GL_ARRAY_BUFFER
+    Bind();
+    GLStateCache::BindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void VertexArray::AddAttributes(const VertexBufferLayout& layout)
+{
+    // the DSA path sets the divisor per binding, mixed divisors would only work on the fallback
+    ASSERT(layout.HasSingleDivisor())
 
     unsigned int offset = 0;
-    const auto& elements = layout.GetElements();
-    for (unsigned int i = 0; i < elements.size(); i++)
+    for (const VertexBufferElement& element : layout.GetElements())
+    {
+        AddAttribute(attributeCount++, element.count, element.type, element.normalized, layout.GetStride(), offset, element.divisor);
+        offset += element.GetSize();
+    }
+}
+
+void VertexArray::AddAttribute(unsigned int index, unsigned int count, unsigned int type, unsigned char normalized, unsigned int stride, unsigned int offset, unsigned int divisor)
+{
+    if (Renderer::SupportsDirectStateAccess())
     {
-        const auto& element = elements[i];
-        GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset))
-        GLCall(glEnableVertexAttribArray(i))
+        // the stride went to the binding in AttachBuffer, the divisor goes there too
+        const unsigned int bindingIndex = bufferCount - 1;
+        GLCall(glEnableVertexArrayAttrib(rendererId, index))
+        GLCall(glVertexArrayAttribFormat(rendererId, index, count, type, normalized, offset))
+        GLCall(glVertexArrayAttribBinding(rendererId, index, bindingIndex))
+
+        if (divisor != 0)
+        {
+            GLCall(glVertexArrayBindingDivisor(rendererId, bindingIndex, divisor))
+        }
+        return;
+    }
 
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+    GLCall(glVertexAttribPointer(index, count, type, normalized, stride, reinterpret_cast<const void*>(static_cast<size_t>(offset))))
+    GLCall(glEnableVertexAttribArray(index))
+
+    if (divisor != 0)
+    {
+        GLCall(glVertexAttribDivisor(index, divisor))
     }
 }
 
 void VertexArray::AddLayout()
 {
 }
+
+void VertexArray::SetFormat(const VertexBufferLayout& layout, unsigned int bindingIndex)
+{
+    if (bindings.size() <= bindingIndex)
+    {
+        bindings.resize(bindingIndex + 1);
+    }
+
+    ASSERT(layout.HasSingleDivisor())
+
+    VertexBinding& binding = bindings[bindingIndex];
+    binding.attributes.clear();
+    binding.stride = layout.GetStride();
+    binding.buffer = 0;
+
+    const bool directStateAccess = Renderer::SupportsDirectStateAccess();
+    if (!directStateAccess)
+    {
+        Bind();
+    }
+
+    unsigned int offset = 0;
+    for (const VertexBufferElement& element : layout.GetElements())
+    {
+        const unsigned int index = attributeCount++;
+        binding.attributes.push_back({ index, element.count, element.type, element.normalized, offset });
+        binding.divisor = element.divisor;
+
+        if (directStateAccess)
+        {
+            GLCall(glEnableVertexArrayAttrib(rendererId, index))
+            GLCall(glVertexArrayAttribFormat(rendererId, index, element.count, element.type, element.normalized, offset))
+            GLCall(glVertexArrayAttribBinding(rendererId, index, bindingIndex))
+        }
+        else if (SupportsAttribBinding())
+        {
+            GLCall(glVertexAttribFormat(index, element.count, element.type, element.normalized, offset))
+            GLCall(glVertexAttribBinding(index, bindingIndex))
+            GLCall(glEnableVertexAttribArray(index))
+        }
+
+        offset += element.GetSize();
+    }
+
+    // the divisor belongs to the binding here, so all attributes of one buffer share it
+    if (directStateAccess && binding.divisor != 0)
+    {
+        GLCall(glVertexArrayBindingDivisor(rendererId, bindingIndex, binding.divisor))
+    }
+    else if (SupportsAttribBinding() && binding.divisor != 0)
+    {
+        GLCall(glVertexBindingDivisor(bindingIndex, binding.divisor))
+    }
+}
+
+void VertexArray::BindVertexBuffer(const VertexBuffer& vb, unsigned int bindingIndex, unsigned int offset) const
+{
+    ASSERT(bindingIndex < bindings.size())
+
+    VertexBinding& binding = bindings[bindingIndex];
+    Bind();
+
+    if (binding.buffer == vb.GetRendererId() && binding.offset == offset)
+    {
+        return;
+    }
+
+    binding.buffer = vb.GetRendererId();
+    binding.offset = offset;
+
+    if (SupportsAttribBinding())
+    {
+        GLCall(glBindVertexBuffer(bindingIndex, binding.buffer, offset, binding.stride))
+        return;
+    }
+
+    // fallback: glVertexAttribPointer captures the buffer bound to GL_ARRAY_BUFFER, so re-point every attribute
+    vb.Bind();
+    for (const AttributeFormat& attribute : binding.attributes)
+    {
+        GLCall(glVertexAttribPointer(attribute.index, attribute.count, attribute.type, attribute.normalized, binding.stride,
+            reinterpret_cast<const void*>(static_cast<size_t>(offset + attribute.relativeOffset))))
+        GLCall(glEnableVertexAttribArray(attribute.index))
+
+        if (binding.divisor != 0)
+        {
+            GLCall(glVertexAttribDivisor(attribute.index, binding.divisor))
+        }
+    }
+}
+
+bool VertexArray::SupportsAttribBinding()
+{
+    return GLEW_ARB_vertex_attrib_binding != 0;
+}
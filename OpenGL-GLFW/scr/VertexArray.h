@@ -1,8 +1,17 @@
 ﻿#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 #include "VertexBuffer.h"
 
+class IndexBuffer;
+class StreamBuffer;
 class VertexBufferLayout;
 
+template<typename... Attributes>
+struct Layout;
+
 class VertexArray
 {
 public:
@@ -12,8 +21,55 @@ public:
     void Bind() const;
     void Unbind() const;
     void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+    // Attributes start at offset 0 of the stream buffer, draws pick their data with a base vertex
+    void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
+    // Compile time layout, works with any buffer type, defined in VertexLayout.h
+    template<typename Buffer, typename... Attributes>
+    void AddBuffer(const Buffer& buffer, const Layout<Attributes...>& layout);
     void AddLayout();
+    // The element buffer is vertex array state, attach it here instead of binding it while the array is bound
+    void SetIndexBuffer(const IndexBuffer& ib);
+
+    // Format only vertex arrays: SetFormat describes the attributes once, BindVertexBuffer swaps the buffer
+    // behind them per draw, so every mesh of a vertex format shares one vertex array. Uses
+    // ARB_vertex_attrib_binding when available, otherwise re-points the attributes at the new buffer.
+    void SetFormat(const VertexBufferLayout& layout, unsigned int bindingIndex = 0);
+    void BindVertexBuffer(const VertexBuffer& vb, unsigned int bindingIndex = 0, unsigned int offset = 0) const;
+    static bool SupportsAttribBinding();
+
+    unsigned int GetRendererId() const { return rendererId; }
 
 private:
+    // Points the attributes added next at buffer, as its own binding under direct state access
+    void AttachBuffer(unsigned int buffer, unsigned int stride);
+    void AddAttributes(const VertexBufferLayout& layout);
+    template<typename... Attributes, size_t... Indices>
+    void AddAttributes(std::index_sequence<Indices...>);
+    void AddAttribute(unsigned int index, unsigned int count, unsigned int type, unsigned char normalized, unsigned int stride, unsigned int offset, unsigned int divisor);
+
+    struct AttributeFormat
+    {
+        unsigned int index;
+        unsigned int count;
+        unsigned int type;
+        unsigned char normalized;
+        unsigned int relativeOffset;
+    };
+
+    struct VertexBinding
+    {
+        std::vector<AttributeFormat> attributes;
+        unsigned int stride = 0;
+        unsigned int divisor = 0;
+        // what is bound right now, to skip rebinding the same buffer
+        unsigned int buffer = 0;
+        unsigned int offset = 0;
+    };
+
     unsigned int rendererId;
+    // buffers added later continue after the attributes of the previous ones
+    unsigned int attributeCount;
+    // buffers attached by AddBuffer, the last one is the binding new attributes read from
+    unsigned int bufferCount;
+    mutable std::vector<VertexBinding> bindings;
 };
@@ -0,0 +1,99 @@
+﻿#include "VertexArrayCache.h"
+
+#include "Renderer.h"
+
+const VertexArray& VertexArrayCache::Get(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout, const IndexBuffer* indexBuffer)
+{
+    const Key key { HashLayout(layout), vertexBuffer.GetRendererId(), indexBuffer ? indexBuffer->GetRendererId() : 0 };
+
+    const auto cached = entries.find(key);
+    if (cached != entries.end())
+    {
+        // a different layout with the same 64 bit hash would silently draw garbage
+        ASSERT(LayoutsEqual(cached->second.layout, layout))
+
+        stats.hits++;
+        stats.attributeSetupsSaved += static_cast<unsigned int>(layout.GetElements().size());
+        return *cached->second.vertexArray;
+    }
+
+    stats.misses++;
+
+    std::unique_ptr<VertexArray> vertexArray(new VertexArray());
+    vertexArray->AddBuffer(vertexBuffer, layout);
+    if (indexBuffer)
+    {
+        vertexArray->SetIndexBuffer(*indexBuffer);
+    }
+    vertexArray->Unbind();
+
+    const VertexArray& result = *vertexArray;
+    entries.emplace(key, Entry { layout, std::move(vertexArray) });
+    return result;
+}
+
+void VertexArrayCache::Evict(const BufferObject& buffer)
+{
+    const unsigned int id = buffer.GetRendererId();
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->first.vertexBuffer == id || it->first.indexBuffer == id)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void VertexArrayCache::Clear()
+{
+    entries.clear();
+}
+
+uint64_t VertexArrayCache::HashLayout(const VertexBufferLayout& layout)
+{
+    // FNV-1a over the fields that end up in glVertexAttribPointer
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const auto mix = [&hash](uint64_t value)
+    {
+        hash ^= value;
+        hash *= 0x100000001B3ull;
+    };
+
+    mix(layout.GetStride());
+    for (const VertexBufferElement& element : layout.GetElements())
+    {
+        mix(element.count);
+        mix(element.type);
+        mix(element.normalized);
+        mix(element.divisor);
+    }
+
+    return hash;
+}
+
+bool VertexArrayCache::LayoutsEqual(const VertexBufferLayout& a, const VertexBufferLayout& b)
+{
+    const auto& elementsA = a.GetElements();
+    const auto& elementsB = b.GetElements();
+    if (a.GetStride() != b.GetStride() || elementsA.size() != elementsB.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < elementsA.size(); i++)
+    {
+        const VertexBufferElement& elementA = elementsA[i];
+        const VertexBufferElement& elementB = elementsB[i];
+        if (elementA.count != elementB.count || elementA.type != elementB.type || elementA.normalized != elementB.normalized || elementA.divisor != elementB.divisor)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "BufferObject.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+struct VertexArrayCacheStats
+{
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    // glVertexAttribPointer setups a hit did not have to repeat
+    unsigned int attributeSetupsSaved = 0;
+};
+
+// Hands out one configured vertex array per (layout, vertex buffer, index buffer) combination, so meshes
+// sharing buffers share the vertex array instead of each building its own.
+class VertexArrayCache
+{
+public:
+    VertexArrayCache() = default;
+    ~VertexArrayCache() = default;
+
+    const VertexArray& Get(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout, const IndexBuffer* indexBuffer = nullptr);
+
+    // GL reuses the names of deleted buffers, call before destroying a buffer that went through Get
+    void Evict(const BufferObject& buffer);
+    void Clear();
+
+    unsigned int GetVertexArrayCount() const { return static_cast<unsigned int>(entries.size()); }
+    const VertexArrayCacheStats& GetStats() const { return stats; }
+    void ResetStats() { stats = VertexArrayCacheStats(); }
+
+private:
+    struct Key
+    {
+        uint64_t layoutHash;
+        unsigned int vertexBuffer;
+        unsigned int indexBuffer;
+
+        bool operator==(const Key& other) const
+        {
+            return layoutHash == other.layoutHash && vertexBuffer == other.vertexBuffer && indexBuffer == other.indexBuffer;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return static_cast<size_t>(key.layoutHash ^ (static_cast<uint64_t>(key.vertexBuffer) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(key.indexBuffer) << 32));
+        }
+    };
+
+    struct Entry
+    {
+        VertexBufferLayout layout;
+        std::unique_ptr<VertexArray> vertexArray;
+    };
+
+    static uint64_t HashLayout(const VertexBufferLayout& layout);
+    static bool LayoutsEqual(const VertexBufferLayout& a, const VertexBufferLayout& b);
+
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    VertexArrayCacheStats stats;
+};
@@ -1,24 +1,12 @@
 ﻿#include "VertexBuffer.h"
 #include "Renderer.h"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned size)
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage)
+    : BufferObject(GL_ARRAY_BUFFER, data, size, usage)
 {
-    GLCall(glGenBuffers(1, &rendererId))
-    Bind();
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW))
 }
 
-VertexBuffer::~VertexBuffer()
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+    : BufferObject(GL_ARRAY_BUFFER, nullptr, size, usage)
 {
-    GLCall(glDeleteBuffers(1, &rendererId))
-}
-
-void VertexBuffer::Bind() const
-{
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, rendererId))
-}
-
-void VertexBuffer::Unbind() const
-{
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0))
 }
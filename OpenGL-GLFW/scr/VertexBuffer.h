@@ -1,14 +1,12 @@
 ﻿#pragma once
 
-class VertexBuffer
+#include "BufferObject.h"
+
+class VertexBuffer : public BufferObject
 {
 public:
-    VertexBuffer(const void* data, unsigned int size);
-    ~VertexBuffer();
-
-    void Bind() const;
-    void Unbind() const;
-    
-private:
-    unsigned int rendererId;
+    VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
+    // Allocates an empty buffer to be filled later with Update or Map
+    VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
+    ~VertexBuffer() = default;
 };
@@ -4,12 +4,15 @@
 #include <GL/glew.h>
 
 #include "Renderer.h"
+#include "VertexLayout.h"
 
 struct VertexBufferElement
 {
     unsigned int count;
     unsigned int type;
     unsigned char normalized;
+    // 0 advances per vertex, N advances once every N instances
+    unsigned int divisor;
 
     static unsigned int GetSizeOfType(unsigned int type)
     {
@@ -21,66 +24,75 @@ struct VertexBufferElement
                 return 4;
             case GL_UNSIGNED_BYTE:
                 return 1;
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_SHORT:
+                return 2;
+            case GL_UNSIGNED_SHORT:
+                return 2;
+            case GL_INT_2_10_10_10_REV:
+                return 4;
         }
 
         ASSERT(false)
         return 0;
     }
+
+    // Bytes the element occupies in a vertex, packed formats hold all their components in one type
+    unsigned int GetSize() const
+    {
+        return type == GL_INT_2_10_10_10_REV ? GetSizeOfType(type) : count * GetSizeOfType(type);
+    }
 };
 
 class VertexBufferLayout
 {
 public:
     VertexBufferLayout()
-        : stride(0) {}
+        : stride(0), divisor(0) {}
     ~VertexBufferLayout() = default;
 
+    // Runtime counterpart of Layout<Attr<T, count>...>, for layouts only known once the program runs
     template<typename T>
     void Push(unsigned int count)
     {
-        ASSERT(false);
+        ASSERT(!AttributeTraits<T>::Packed || count == 4)
+        PushElement(count, AttributeTraits<T>::Type, AttributeTraits<T>::Normalized);
     }
 
-    template<>
-    void Push<float>(unsigned int count)
-    {
-        VertexBufferElement newElement;
-        newElement.count = count;
-        newElement.type = GL_FLOAT;
-        newElement.normalized = GL_FALSE;
-        
-        elements.emplace_back(newElement);
-        stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
-    }
+    // Elements pushed after this call become per-instance attributes (a mat4 is pushed as four vec4).
+    // A buffer binding has a single divisor, so one layout should not mix them.
+    void SetDivisor(unsigned int instanceDivisor) { divisor = instanceDivisor; }
 
-    template<>
-    void Push<unsigned int>(unsigned int count)
+    unsigned int GetStride() const { return stride; }
+    bool HasSingleDivisor() const
     {
-        VertexBufferElement newElement;
-        newElement.count = count;
-        newElement.type = GL_UNSIGNED_INT;
-        newElement.normalized = GL_FALSE;
-        
-        elements.emplace_back(newElement);
-        stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
-    }
+        for (const VertexBufferElement& element : elements)
+        {
+            if (element.divisor != elements.front().divisor)
+            {
+                return false;
+            }
+        }
 
-    template<>
-    void Push<unsigned char>(unsigned int count)
+        return true;
+    }
+    const std::vector<VertexBufferElement>& GetElements() const { return elements; }
+    
+private:
+    void PushElement(unsigned int count, unsigned int type, unsigned char normalized)
     {
         VertexBufferElement newElement;
         newElement.count = count;
-        newElement.type = GL_UNSIGNED_BYTE;
-        newElement.normalized = GL_TRUE;
-        
+        newElement.type = type;
+        newElement.normalized = normalized;
+        newElement.divisor = divisor;
+
         elements.emplace_back(newElement);
-        stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+        stride += newElement.GetSize();
     }
 
-    unsigned int GetStride() const { return stride; }
-    const std::vector<VertexBufferElement>& GetElements() const { return elements; }
-    
-private:
     std::vector<VertexBufferElement> elements;
     unsigned int stride;
+    unsigned int divisor;
 };
@@ -0,0 +1,182 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include "VertexArray.h"
+#include "VertexPacking.h"
+
+// GL description of every C++ type an attribute can be stored as. Types without a specialization
+// fail to compile instead of asserting at runtime.
+template<typename T>
+struct AttributeTraits;
+
+template<>
+struct AttributeTraits<float>
+{
+    static constexpr unsigned int Type = GL_FLOAT;
+    static constexpr unsigned int Size = 4;
+    static constexpr unsigned char Normalized = GL_FALSE;
+    static constexpr bool Packed = false;
+};
+
+template<>
+struct AttributeTraits<unsigned int>
+{
+    static constexpr unsigned int Type = GL_UNSIGNED_INT;
+    static constexpr unsigned int Size = 4;
+    static constexpr unsigned char Normalized = GL_FALSE;
+    static constexpr bool Packed = false;
+};
+
+template<>
+struct AttributeTraits<unsigned char>
+{
+    static constexpr unsigned int Type = GL_UNSIGNED_BYTE;
+    static constexpr unsigned int Size = 1;
+    static constexpr unsigned char Normalized = GL_TRUE;
+    static constexpr bool Packed = false;
+};
+
+template<>
+struct AttributeTraits<Half>
+{
+    static constexpr unsigned int Type = GL_HALF_FLOAT;
+    static constexpr unsigned int Size = 2;
+    static constexpr unsigned char Normalized = GL_FALSE;
+    static constexpr bool Packed = false;
+};
+
+// snorm16, e.g. two per normal with VertexPacking::PackOctahedral
+template<>
+struct AttributeTraits<short>
+{
+    static constexpr unsigned int Type = GL_SHORT;
+    static constexpr unsigned int Size = 2;
+    static constexpr unsigned char Normalized = GL_TRUE;
+    static constexpr bool Packed = false;
+};
+
+// unorm16, e.g. texture coordinates inside [0, 1]
+template<>
+struct AttributeTraits<unsigned short>
+{
+    static constexpr unsigned int Type = GL_UNSIGNED_SHORT;
+    static constexpr unsigned int Size = 2;
+    static constexpr unsigned char Normalized = GL_TRUE;
+    static constexpr bool Packed = false;
+};
+
+// all four components live in one 32 bit value
+template<>
+struct AttributeTraits<PackedNormal>
+{
+    static constexpr unsigned int Type = GL_INT_2_10_10_10_REV;
+    static constexpr unsigned int Size = 4;
+    static constexpr unsigned char Normalized = GL_TRUE;
+    static constexpr bool Packed = true;
+};
+
+// Count components of T, Divisor 0 advances per vertex and N once every N instances
+template<typename T, unsigned int ComponentCount, unsigned int InstanceDivisor = 0>
+struct Attr
+{
+    static_assert(ComponentCount >= 1 && ComponentCount <= 4, "attributes have 1 to 4 components");
+    static_assert(!AttributeTraits<T>::Packed || ComponentCount == 4, "packed formats always have 4 components");
+
+    static constexpr unsigned int Count = ComponentCount;
+    static constexpr unsigned int Type = AttributeTraits<T>::Type;
+    static constexpr unsigned char Normalized = AttributeTraits<T>::Normalized;
+    static constexpr unsigned int Divisor = InstanceDivisor;
+    static constexpr unsigned int Size = AttributeTraits<T>::Packed ? AttributeTraits<T>::Size : ComponentCount * AttributeTraits<T>::Size;
+};
+
+namespace VertexLayoutDetail
+{
+    constexpr unsigned int Sum()
+    {
+        return 0;
+    }
+
+    template<typename... Rest>
+    constexpr unsigned int Sum(unsigned int first, Rest... rest)
+    {
+        return first + Sum(rest...);
+    }
+
+    constexpr bool AllEqual(unsigned int)
+    {
+        return true;
+    }
+
+    template<typename... Rest>
+    constexpr bool AllEqual(unsigned int first, unsigned int second, Rest... rest)
+    {
+        return first == second && AllEqual(second, rest...);
+    }
+
+    // offset of attribute Index is the size of every attribute before it
+    template<unsigned int Index, typename... Attributes>
+    struct OffsetOf;
+
+    template<typename First, typename... Rest>
+    struct OffsetOf<0, First, Rest...>
+    {
+        static constexpr unsigned int Value = 0;
+    };
+
+    template<unsigned int Index, typename First, typename... Rest>
+    struct OffsetOf<Index, First, Rest...>
+    {
+        static constexpr unsigned int Value = First::Size + OffsetOf<Index - 1, Rest...>::Value;
+    };
+}
+
+// Interleaved vertex layout fixed at compile time, check it against the vertex struct it describes:
+//
+//     using QuadLayout = Layout<Attr<float, 2>, Attr<float, 2>>;
+//     static_assert(QuadLayout::Matches<QuadVertex>(), "...");
+//     static_assert(QuadLayout::Offset<1>() == offsetof(QuadVertex, texCoord), "...");
+template<typename... Attributes>
+struct Layout
+{
+    static_assert(sizeof...(Attributes) > 0, "a layout needs at least one attribute");
+    static_assert(VertexLayoutDetail::AllEqual(Attributes::Divisor...), "the attributes of one buffer share its binding's divisor, give per instance data its own buffer");
+
+    static constexpr unsigned int Count = sizeof...(Attributes);
+    static constexpr unsigned int Stride = VertexLayoutDetail::Sum(Attributes::Size...);
+
+    template<unsigned int Index>
+    static constexpr unsigned int Offset()
+    {
+        return VertexLayoutDetail::OffsetOf<Index, Attributes...>::Value;
+    }
+
+    template<typename Vertex>
+    static constexpr bool Matches()
+    {
+        return sizeof(Vertex) == Stride;
+    }
+};
+
+template<typename Buffer, typename... Attributes>
+void VertexArray::AddBuffer(const Buffer& buffer, const Layout<Attributes...>&)
+{
+    AttachBuffer(buffer.GetRendererId(), Layout<Attributes...>::Stride);
+    AddAttributes<Attributes...>(std::index_sequence_for<Attributes...>());
+}
+
+template<typename... Attributes, size_t... Indices>
+void VertexArray::AddAttributes(std::index_sequence<Indices...>)
+{
+    constexpr unsigned int stride = Layout<Attributes...>::Stride;
+
+    // one AddAttribute call per attribute with every argument a constant, no loop and no element list
+    const int unrolled[] = { (AddAttribute(attributeCount + static_cast<unsigned int>(Indices), Attributes::Count, Attributes::Type, Attributes::Normalized,
+        stride, VertexLayoutDetail::OffsetOf<static_cast<unsigned int>(Indices), Attributes...>::Value, Attributes::Divisor), 0)... };
+    static_cast<void>(unrolled);
+
+    attributeCount += static_cast<unsigned int>(sizeof...(Attributes));
+}
@@ -0,0 +1,296 @@
+﻿#include "VertexPacking.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define VERTEX_PACKING_USE_SSE 1
+#include <immintrin.h>
+#endif
+
+// MSVC has no switch for F16C alone, /arch:AVX2 implies it
+#if defined(VERTEX_PACKING_USE_SSE) && (defined(__F16C__) || defined(__AVX2__))
+#define VERTEX_PACKING_USE_F16C 1
+#endif
+
+namespace
+{
+    short ToSnorm16(float value)
+    {
+        const float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<short>(std::lrint(clamped * 32767.0f));
+    }
+
+    int ToSnorm(float value, float scale)
+    {
+        const float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<int>(std::lrint(clamped * scale));
+    }
+
+    glm::vec2 EncodeOctahedral(const glm::vec3& normal)
+    {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        glm::vec2 encoded(normal.x / length, normal.y / length);
+
+        // the lower hemisphere folds over the diagonals of the upper one
+        if (normal.z < 0.0f)
+        {
+            const glm::vec2 folded(1.0f - std::abs(encoded.y), 1.0f - std::abs(encoded.x));
+            encoded.x = encoded.x >= 0.0f ? folded.x : -folded.x;
+            encoded.y = encoded.y >= 0.0f ? folded.y : -folded.y;
+        }
+
+        return encoded;
+    }
+
+#if defined(VERTEX_PACKING_USE_SSE)
+    __m128 Clamp(__m128 value, __m128 low, __m128 high)
+    {
+        return _mm_min_ps(_mm_max_ps(value, low), high);
+    }
+
+    __m128 Abs(__m128 value)
+    {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+    }
+#endif
+}
+
+void VertexPacking::PackHalf(const float* source, Half* destination, unsigned int count)
+{
+    unsigned int i = 0;
+
+#if defined(VERTEX_PACKING_USE_F16C)
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i low = _mm_cvtps_ph(_mm_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i high = _mm_cvtps_ph(_mm_loadu_ps(source + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi64(low, high));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        destination[i] = ToHalf(source[i]);
+    }
+}
+
+void VertexPacking::PackSnorm16(const float* source, short* destination, unsigned int count)
+{
+    unsigned int i = 0;
+
+#if defined(VERTEX_PACKING_USE_SSE)
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i a = _mm_cvtps_epi32(_mm_mul_ps(Clamp(_mm_loadu_ps(source + i), low, high), scale));
+        const __m128i b = _mm_cvtps_epi32(_mm_mul_ps(Clamp(_mm_loadu_ps(source + i + 4), low, high), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(a, b));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        destination[i] = ToSnorm16(source[i]);
+    }
+}
+
+void VertexPacking::PackUnorm16(const float* source, unsigned short* destination, unsigned int count)
+{
+    unsigned int i = 0;
+
+#if defined(VERTEX_PACKING_USE_SSE)
+    const __m128 low = _mm_set1_ps(0.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    // SSE2 only packs signed, shift into the signed range and flip the top bit back afterwards
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i a = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(Clamp(_mm_loadu_ps(source + i), low, high), scale)), bias);
+        const __m128i b = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(Clamp(_mm_loadu_ps(source + i + 4), low, high), scale)), bias);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_xor_si128(_mm_packs_epi32(a, b), flip));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        const float clamped = source[i] < 0.0f ? 0.0f : (source[i] > 1.0f ? 1.0f : source[i]);
+        destination[i] = static_cast<unsigned short>(std::lrint(clamped * 65535.0f));
+    }
+}
+
+void VertexPacking::PackNormal(const glm::vec4* source, PackedNormal* destination, unsigned int count)
+{
+    unsigned int i = 0;
+
+#if defined(VERTEX_PACKING_USE_SSE)
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set_ps(1.0f, 511.0f, 511.0f, 511.0f);
+    const __m128i mask10 = _mm_set1_epi32(0x3FF);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // one vector per vertex, scaled per component, then transposed into one vector per component
+        __m128 v0 = _mm_mul_ps(Clamp(_mm_loadu_ps(&source[i + 0].x), low, high), scale);
+        __m128 v1 = _mm_mul_ps(Clamp(_mm_loadu_ps(&source[i + 1].x), low, high), scale);
+        __m128 v2 = _mm_mul_ps(Clamp(_mm_loadu_ps(&source[i + 2].x), low, high), scale);
+        __m128 v3 = _mm_mul_ps(Clamp(_mm_loadu_ps(&source[i + 3].x), low, high), scale);
+        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+
+        const __m128i x = _mm_and_si128(_mm_cvtps_epi32(v0), mask10);
+        const __m128i y = _mm_slli_epi32(_mm_and_si128(_mm_cvtps_epi32(v1), mask10), 10);
+        const __m128i z = _mm_slli_epi32(_mm_and_si128(_mm_cvtps_epi32(v2), mask10), 20);
+        const __m128i w = _mm_slli_epi32(_mm_cvtps_epi32(v3), 30);
+
+        const __m128i packed = _mm_or_si128(_mm_or_si128(x, y), _mm_or_si128(z, w));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        const glm::vec4& value = source[i];
+        const unsigned int x = static_cast<unsigned int>(ToSnorm(value.x, 511.0f)) & 0x3FF;
+        const unsigned int y = static_cast<unsigned int>(ToSnorm(value.y, 511.0f)) & 0x3FF;
+        const unsigned int z = static_cast<unsigned int>(ToSnorm(value.z, 511.0f)) & 0x3FF;
+        const unsigned int w = static_cast<unsigned int>(ToSnorm(value.w, 1.0f)) & 0x3;
+        destination[i].bits = x | (y << 10) | (z << 20) | (w << 30);
+    }
+}
+
+void VertexPacking::PackOctahedral(const glm::vec3* source, short* destination, unsigned int count)
+{
+    unsigned int i = 0;
+
+#if defined(VERTEX_PACKING_USE_SSE)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x = _mm_set_ps(source[i + 3].x, source[i + 2].x, source[i + 1].x, source[i].x);
+        const __m128 y = _mm_set_ps(source[i + 3].y, source[i + 2].y, source[i + 1].y, source[i].y);
+        const __m128 z = _mm_set_ps(source[i + 3].z, source[i + 2].z, source[i + 1].z, source[i].z);
+
+        const __m128 inverseLength = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(Abs(x), Abs(y)), Abs(z)));
+        const __m128 ex = _mm_mul_ps(x, inverseLength);
+        const __m128 ey = _mm_mul_ps(y, inverseLength);
+
+        // fold the lower hemisphere, copying the sign of the unfolded value (0 counts as positive, like the scalar path)
+        const __m128 negativeX = _mm_and_ps(_mm_cmplt_ps(ex, zero), signBit);
+        const __m128 negativeY = _mm_and_ps(_mm_cmplt_ps(ey, zero), signBit);
+        const __m128 foldedX = _mm_or_ps(_mm_sub_ps(one, Abs(ey)), negativeX);
+        const __m128 foldedY = _mm_or_ps(_mm_sub_ps(one, Abs(ex)), negativeY);
+
+        const __m128 lower = _mm_cmplt_ps(z, zero);
+        const __m128 resultX = _mm_or_ps(_mm_and_ps(lower, foldedX), _mm_andnot_ps(lower, ex));
+        const __m128 resultY = _mm_or_ps(_mm_and_ps(lower, foldedY), _mm_andnot_ps(lower, ey));
+
+        // interleave back into x, y pairs
+        const __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpacklo_ps(resultX, resultY), scale));
+        const __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpackhi_ps(resultX, resultY), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 2), _mm_packs_epi32(a, b));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        const glm::vec2 encoded = EncodeOctahedral(source[i]);
+        destination[i * 2 + 0] = ToSnorm16(encoded.x);
+        destination[i * 2 + 1] = ToSnorm16(encoded.y);
+    }
+}
+
+Half VertexPacking::ToHalf(float value)
+{
+    // round to nearest even, including subnormals, matching what F16C produces
+    unsigned int bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const unsigned int sign = (bits >> 16) & 0x8000;
+    bits &= 0x7FFFFFFF;
+
+    unsigned int half;
+    if (bits >= 0x47800000)
+    {
+        // too large for a half (or inf/NaN), NaN stays a quiet NaN
+        half = bits > 0x7F800000 ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < 0x38800000)
+    {
+        // subnormal half or zero, adding the magic number lets the FPU do the rounding
+        const unsigned int magicBits = 0x3F000000;
+        float magic;
+        float magnitude;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&magnitude, &bits, sizeof(magnitude));
+        magnitude += magic;
+
+        unsigned int result;
+        std::memcpy(&result, &magnitude, sizeof(result));
+        half = result - magicBits;
+    }
+    else
+    {
+        const unsigned int mantissaOdd = (bits >> 13) & 1;
+        bits += 0xC8000FFF + mantissaOdd;
+        half = bits >> 13;
+    }
+
+    return { static_cast<unsigned short>(half | sign) };
+}
+
+float VertexPacking::FromHalf(Half value)
+{
+    const unsigned int sign = static_cast<unsigned int>(value.bits & 0x8000) << 16;
+    const unsigned int exponent = (value.bits >> 10) & 0x1F;
+    const unsigned int mantissa = value.bits & 0x3FF;
+
+    float magnitude;
+    if (exponent == 0)
+    {
+        magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    }
+    else if (exponent == 31)
+    {
+        magnitude = mantissa == 0 ? INFINITY : NAN;
+    }
+    else
+    {
+        magnitude = std::ldexp(static_cast<float>(mantissa | 0x400), static_cast<int>(exponent) - 25);
+    }
+
+    unsigned int bits;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits |= sign;
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+glm::vec3 VertexPacking::DecodeOctahedral(short x, short y)
+{
+    const float ex = std::fmax(x / 32767.0f, -1.0f);
+    const float ey = std::fmax(y / 32767.0f, -1.0f);
+
+    glm::vec3 normal(ex, ey, 1.0f - std::abs(ex) - std::abs(ey));
+    if (normal.z < 0.0f)
+    {
+        const float foldedX = 1.0f - std::abs(normal.y);
+        const float foldedY = 1.0f - std::abs(normal.x);
+        normal.x = normal.x >= 0.0f ? foldedX : -foldedX;
+        normal.y = normal.y >= 0.0f ? foldedY : -foldedY;
+    }
+
+    return glm::normalize(normal);
+}
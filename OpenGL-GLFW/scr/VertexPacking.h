@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include <GLM/glm.hpp>
+
+// Storage types of the compressed attribute formats, used as VertexBufferLayout::Push arguments
+// and as targets of the VertexPacking converters
+
+// IEEE 754 binary16, attribute type GL_HALF_FLOAT
+struct Half
+{
+    unsigned short bits;
+};
+
+// x, y, z as signed normalized 10 bits and w as signed normalized 2 bits, attribute type GL_INT_2_10_10_10_REV.
+// Always pushed with a count of 4, the w of a tangent keeps the bitangent sign.
+struct PackedNormal
+{
+    unsigned int bits;
+};
+
+// Float to compressed format converters, run once at upload time. The loops do 4 or 8 values per
+// iteration with SSE (and F16C for halves when the compiler targets it) and finish the tail in scalar code.
+class VertexPacking
+{
+public:
+    static void PackHalf(const float* source, Half* destination, unsigned int count);
+    // Clamps to [-1, 1], read back in the shader as a normalized GL_SHORT
+    static void PackSnorm16(const float* source, short* destination, unsigned int count);
+    // Clamps to [0, 1], read back in the shader as a normalized GL_UNSIGNED_SHORT
+    static void PackUnorm16(const float* source, unsigned short* destination, unsigned int count);
+    static void PackNormal(const glm::vec4* source, PackedNormal* destination, unsigned int count);
+    // Unit normals as two snorm16 per normal (4 bytes instead of 12), decoded in the vertex shader with
+    //
+    //     vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    //     if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+    //     n = normalize(n);
+    static void PackOctahedral(const glm::vec3* source, short* destination, unsigned int count);
+
+    static Half ToHalf(float value);
+    static float FromHalf(Half value);
+    static glm::vec3 DecodeOctahedral(short x, short y);
+};